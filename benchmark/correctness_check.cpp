@@ -0,0 +1,381 @@
+// Checks that every way of reading a field agrees with a plain walk of the message.
+// The check synthesizes serialized messages from definition strings, so no ROS master is required.
+// Each message is also read after truncating it at every length, where the fields that still lie within it must
+// read the same values, and the fields past its end must fail. The check exits with a nonzero status on any mismatch.
+
+#include "message_introspection/introspector.h"
+#include "message_introspection/message_filter.h"
+#include "definitions.h"
+#include "synthesis.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+using namespace message_introspection;
+
+// PLAIN WALK
+/// \brief A primitive field found by the plain walk.
+struct walked_field_t
+{
+    /// \brief The field's path, such as "markers[1].points[0].x".
+    std::string path;
+    /// \brief The field's path with every array index replaced by a wildcard, such as "markers[*].points[*].x".
+    std::string query;
+    /// \brief Indicates if the field is a string.
+    bool is_string;
+    /// \brief The field's value, if it is not a string.
+    double number;
+    /// \brief The field's value, if it is a string.
+    std::string text;
+};
+/// \brief Reads a little endian value from a serialized message.
+template<typename T>
+T read_value(const uint8_t* bytes)
+{
+    T value;
+    std::memcpy(&value, bytes, sizeof(T));
+    return value;
+}
+/// \brief Writes a little endian value to a serialized message.
+template<typename T>
+void write_value(uint8_t* bytes, T value)
+{
+    std::memcpy(bytes, &value, sizeof(T));
+}
+/// \brief Overwrites a primitive with a value derived from a stamp, so that every field of a message differs.
+/// \param primitive_type The primitive's type.
+/// \param bytes The primitive's serialized bytes.
+/// \param stamp The stamp, which is distinct for each primitive of the message.
+void stamp_primitive(definition_t::primitive_type_t primitive_type, uint8_t* bytes, uint32_t stamp)
+{
+    switch(primitive_type)
+    {
+        case definition_t::primitive_type_t::BOOL: write_value<uint8_t>(bytes, stamp % 2); break;
+        case definition_t::primitive_type_t::INT8: write_value<int8_t>(bytes, -static_cast<int8_t>(stamp % 100)); break;
+        case definition_t::primitive_type_t::INT16: write_value<int16_t>(bytes, -static_cast<int16_t>(stamp)); break;
+        case definition_t::primitive_type_t::INT32: write_value<int32_t>(bytes, -static_cast<int32_t>(stamp) * 1000); break;
+        case definition_t::primitive_type_t::INT64: write_value<int64_t>(bytes, -static_cast<int64_t>(stamp) * 1000000000000); break;
+        case definition_t::primitive_type_t::UINT8: write_value<uint8_t>(bytes, stamp % 200); break;
+        case definition_t::primitive_type_t::UINT16: write_value<uint16_t>(bytes, stamp); break;
+        case definition_t::primitive_type_t::UINT32: write_value<uint32_t>(bytes, stamp * 100000); break;
+        case definition_t::primitive_type_t::UINT64: write_value<uint64_t>(bytes, static_cast<uint64_t>(stamp) * 1000000000000); break;
+        case definition_t::primitive_type_t::FLOAT32: write_value<float>(bytes, stamp + 0.5f); break;
+        case definition_t::primitive_type_t::FLOAT64: write_value<double>(bytes, stamp + 0.25); break;
+        case definition_t::primitive_type_t::TIME:
+        case definition_t::primitive_type_t::DURATION:
+        {
+            write_value<uint32_t>(bytes, stamp);
+            write_value<uint32_t>(bytes + 4, stamp * 1000);
+            break;
+        }
+        default: break;
+    }
+}
+/// \brief Reads a primitive as a number, as introspector::get_number() documents it.
+/// \param primitive_type The primitive's type, which is not a string.
+/// \param bytes The primitive's serialized bytes.
+/// \returns The primitive's value.
+double read_primitive(definition_t::primitive_type_t primitive_type, const uint8_t* bytes)
+{
+    switch(primitive_type)
+    {
+        case definition_t::primitive_type_t::BOOL: return read_value<uint8_t>(bytes) != 0 ? 1.0 : 0.0;
+        case definition_t::primitive_type_t::INT8: return read_value<int8_t>(bytes);
+        case definition_t::primitive_type_t::INT16: return read_value<int16_t>(bytes);
+        case definition_t::primitive_type_t::INT32: return read_value<int32_t>(bytes);
+        case definition_t::primitive_type_t::INT64: return static_cast<double>(read_value<int64_t>(bytes));
+        case definition_t::primitive_type_t::UINT8: return read_value<uint8_t>(bytes);
+        case definition_t::primitive_type_t::UINT16: return read_value<uint16_t>(bytes);
+        case definition_t::primitive_type_t::UINT32: return read_value<uint32_t>(bytes);
+        case definition_t::primitive_type_t::UINT64: return static_cast<double>(read_value<uint64_t>(bytes));
+        case definition_t::primitive_type_t::FLOAT32: return read_value<float>(bytes);
+        case definition_t::primitive_type_t::FLOAT64: return read_value<double>(bytes);
+        case definition_t::primitive_type_t::TIME:
+        case definition_t::primitive_type_t::DURATION:
+        {
+            return static_cast<double>(read_value<uint32_t>(bytes)) + static_cast<double>(read_value<uint32_t>(bytes + 4)) / 1000000000.0;
+        }
+        default: return 0.0;
+    }
+}
+/// \brief Walks a definition through a serialized message, recording each primitive field that lies within it.
+/// \param definition_tree The definition to walk.
+/// \param bytes The serialized message.
+/// \param length The length of the message, which may be truncated.
+/// \param path The path of the definition's parent, or an empty string for the message's fields.
+/// \param query The query of the definition's parent, or an empty string for the message's fields.
+/// \param position The position of the definition in the message, which is advanced past it.
+/// \param stamp If not nullptr, the primitives are first overwritten with distinct values counted by the stamp.
+/// \param fields The fields to append the walked primitives to.
+/// \returns TRUE if the definition lies within the message, or FALSE if the walk reached the end of the message.
+bool walk(const definition_tree_t& definition_tree, uint8_t* bytes, uint32_t length, const std::string& path, const std::string& query, uint32_t& position, uint32_t* stamp, std::vector<walked_field_t>& fields)
+{
+    const definition_t& definition = definition_tree.definition;
+    std::string field_path = path.empty() ? definition.name() : path + "." + definition.name();
+    std::string field_query = query.empty() ? definition.name() : query + "." + definition.name();
+
+    // Determine the number of instances, reading the length of variable length arrays.
+    uint32_t instances = 1;
+    if(definition.array_type() == definition_t::array_type_t::FIXED_LENGTH)
+    {
+        instances = definition.array_length();
+    }
+    else if(definition.array_type() == definition_t::array_type_t::VARIABLE_LENGTH)
+    {
+        if(static_cast<uint64_t>(position) + 4 > length)
+        {
+            return false;
+        }
+        instances = read_value<uint32_t>(&bytes[position]);
+        position += 4;
+    }
+
+    for(uint32_t i = 0; i < instances; ++i)
+    {
+        walked_field_t field;
+        field.path = field_path;
+        field.query = field_query;
+        if(definition.is_array())
+        {
+            field.path += "[" + std::to_string(i) + "]";
+            field.query += "[*]";
+        }
+
+        if(definition.primitive_type() == definition_t::primitive_type_t::STRING)
+        {
+            // Strings keep their synthesized text, which already differs between instances.
+            if(static_cast<uint64_t>(position) + 4 > length || static_cast<uint64_t>(position) + 4 + read_value<uint32_t>(&bytes[position]) > length)
+            {
+                return false;
+            }
+            uint32_t size = read_value<uint32_t>(&bytes[position]);
+            field.is_string = true;
+            field.number = 0.0;
+            field.text.assign(reinterpret_cast<const char*>(&bytes[position + 4]), size);
+            position += 4 + size;
+            fields.push_back(field);
+        }
+        else if(definition.is_primitive())
+        {
+            if(static_cast<uint64_t>(position) + definition.size() > length)
+            {
+                return false;
+            }
+            if(stamp != nullptr)
+            {
+                stamp_primitive(definition.primitive_type(), &bytes[position], ++(*stamp));
+            }
+            field.is_string = false;
+            field.number = read_primitive(definition.primitive_type(), &bytes[position]);
+            position += definition.size();
+            fields.push_back(field);
+        }
+        else
+        {
+            for(auto child = definition_tree.fields.cbegin(); child != definition_tree.fields.cend(); ++child)
+            {
+                if(!walk(*child, bytes, length, field.path, field.query, position, stamp, fields))
+                {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+/// \brief Walks a serialized message, recording each primitive field that lies within it.
+/// \param definition_tree The message's definition tree.
+/// \param bytes The serialized message.
+/// \param length The length of the message, which may be truncated.
+/// \param stamp If not nullptr, the primitives are first overwritten with distinct values counted by the stamp.
+/// \returns The primitive fields, in the order they are serialized, up to the first field that does not lie within the message.
+std::vector<walked_field_t> walk_message(const definition_tree_t& definition_tree, uint8_t* bytes, uint32_t length, uint32_t* stamp)
+{
+    std::vector<walked_field_t> fields;
+    uint32_t position = 0;
+    for(auto field = definition_tree.fields.cbegin(); field != definition_tree.fields.cend(); ++field)
+    {
+        if(!walk(*field, bytes, length, "", "", position, stamp, fields))
+        {
+            break;
+        }
+    }
+    return fields;
+}
+
+// CHECKS
+/// \brief Counts the reads that were checked, and the reads that disagreed with the plain walk.
+struct tally_t
+{
+    /// \brief The number of reads checked.
+    uint64_t reads;
+    /// \brief The number of reads that disagreed with the plain walk.
+    uint64_t mismatches;
+};
+/// \brief Records the outcome of a read, and describes the first few mismatches.
+/// \param tally The tally to record the outcome in.
+/// \param agrees Indicates if the read agreed with the plain walk.
+/// \param mode The way that the field was read.
+/// \param key The field's path or query.
+/// \param length The length of the message that was read.
+void record(tally_t& tally, bool agrees, const char* mode, const std::string& key, uint32_t length)
+{
+    ++tally.reads;
+    if(!agrees)
+    {
+        if(tally.mismatches < 20)
+        {
+            std::cout << "  mismatch: " << mode << " read of " << key << " in " << length << " B" << std::endl;
+        }
+        ++tally.mismatches;
+    }
+}
+/// \brief Indicates if reading a field agrees with the plain walk.
+/// \param introspector The introspector holding the message.
+/// \param key The field's path or handle.
+/// \param field The field found by the plain walk of the complete message.
+/// \param readable Indicates if the field lies within the message.
+/// \returns TRUE if the field was read with the walked value, or could not be read because it is past the end of the message.
+template<typename key_t>
+bool read_agrees(const introspector& introspector, const key_t& key, const walked_field_t& field, bool readable)
+{
+    if(field.is_string)
+    {
+        std::string value;
+        bool read = introspector.get_string(key, value);
+        return read == readable && (!read || value == field.text);
+    }
+
+    double value;
+    bool read = introspector.get_number(key, value);
+    return read == readable && (!read || value == field.number);
+}
+/// \brief Writes a filter expression that only matches messages holding a field's walked value.
+/// \param field The field found by the plain walk.
+/// \returns The filter expression.
+std::string equality_expression(const walked_field_t& field)
+{
+    std::ostringstream expression;
+    expression << field.path << " == ";
+    if(field.is_string)
+    {
+        expression << "\"" << field.text << "\"";
+    }
+    else
+    {
+        expression << std::setprecision(17) << field.number;
+    }
+    return expression.str();
+}
+
+// CASES
+/// \brief Checks every way of reading a message shape, truncated at every length, against the plain walk.
+/// \returns The number of mismatches.
+uint64_t run_case(const std::string& name, const std::string& type, const std::string& definition, const array_lengths_t& array_lengths)
+{
+    std::string md5 = type + "_md5";
+
+    // Get the definition tree and synthesize a message, stamping each primitive with a distinct value.
+    introspector path_introspector;
+    path_introspector.new_message_type(type, definition, md5);
+    std::vector<uint8_t> bytes;
+    synthesize(path_introspector.definition_tree(), array_lengths, bytes);
+    uint32_t stamp = 0;
+    std::vector<walked_field_t> fields = walk_message(path_introspector.definition_tree(), bytes.data(), bytes.size(), &stamp);
+
+    // The lazy introspector positions fields as they are read.
+    introspector lazy_introspector;
+    lazy_introspector.set_lazy(true);
+
+    // The interest-limited introspector only indexes up to the top level field in the middle of the message.
+    const std::string& middle = fields[fields.size() / 2].path;
+    introspector interest_introspector;
+    interest_introspector.set_interest({middle.substr(0, middle.find_first_of(".["))});
+
+    // Resolve handles, queries and filters on the complete message.
+    path_introspector.new_message(bytes.data(), bytes.size(), md5, type, definition, true);
+    std::vector<field_handle_t> handles(fields.size());
+    std::vector<message_filter> filters(fields.size());
+    std::vector<std::string> query_paths;
+    for(size_t f = 0; f < fields.size(); ++f)
+    {
+        path_introspector.get_handle(fields[f].path, handles[f]);
+        filters[f].compile(equality_expression(fields[f]));
+        if(!fields[f].is_string && std::find(query_paths.begin(), query_paths.end(), fields[f].query) == query_paths.end())
+        {
+            query_paths.push_back(fields[f].query);
+        }
+    }
+    std::vector<field_query_t> queries(query_paths.size());
+    for(size_t q = 0; q < query_paths.size(); ++q)
+    {
+        path_introspector.get_query(query_paths[q], queries[q]);
+    }
+
+    // Read the message truncated at every length, up to the complete message.
+    tally_t tally = {0, 0};
+    std::vector<double> values;
+    for(uint32_t length = 0; length <= bytes.size(); ++length)
+    {
+        // The walk stops at the first field past the end of the message, so the readable fields are a prefix.
+        size_t n_readable = walk_message(path_introspector.definition_tree(), bytes.data(), length, nullptr).size();
+
+        path_introspector.new_message(bytes.data(), length, md5, type, definition, true);
+        lazy_introspector.new_message(bytes.data(), length, md5, type, definition, true);
+        interest_introspector.new_message(bytes.data(), length, md5, type, definition, true);
+
+        for(size_t f = 0; f < fields.size(); ++f)
+        {
+            bool readable = f < n_readable;
+            record(tally, read_agrees(path_introspector, fields[f].path, fields[f], readable), "path", fields[f].path, length);
+            record(tally, read_agrees(path_introspector, handles[f], fields[f], readable), "handle", fields[f].path, length);
+            record(tally, read_agrees(lazy_introspector, fields[f].path, fields[f], readable), "lazy", fields[f].path, length);
+            record(tally, read_agrees(interest_introspector, fields[f].path, fields[f], readable), "interest", fields[f].path, length);
+            record(tally, filters[f].matches(path_introspector) == readable, "filter", filters[f].expression(), length);
+        }
+
+        // A query succeeds if all of its fields are readable, and otherwise returns the values read before the failure.
+        for(size_t q = 0; q < queries.size(); ++q)
+        {
+            std::vector<double> expected;
+            bool complete = true;
+            for(size_t f = 0; f < fields.size(); ++f)
+            {
+                if(fields[f].query == query_paths[q])
+                {
+                    if(f < n_readable)
+                    {
+                        expected.push_back(fields[f].number);
+                    }
+                    else
+                    {
+                        complete = false;
+                    }
+                }
+            }
+            bool read = path_introspector.get_numbers(queries[q], values);
+            bool agrees = read == complete && values.size() <= expected.size() && (!read || values.size() == expected.size()) && std::equal(values.begin(), values.end(), expected.begin());
+            record(tally, agrees, "query", query_paths[q], length);
+        }
+    }
+
+    std::cout << std::left << std::setw(40) << name << std::right << std::setw(8) << fields.size() << " fields"
+              << std::setw(8) << bytes.size() + 1 << " lengths" << std::setw(12) << tally.reads << " reads"
+              << std::setw(8) << tally.mismatches << " mismatches" << std::endl;
+    return tally.mismatches;
+}
+
+int main()
+{
+    // Every array has elements, so a truncated array always has fields past the end of the message.
+    uint64_t mismatches = 0;
+    mismatches += run_case("sensor_msgs/Imu", "sensor_msgs/Imu", imu_definition, {0, {}});
+    mismatches += run_case("sensor_msgs/JointState[3]", "sensor_msgs/JointState", joint_state_definition, {3, {}});
+    mismatches += run_case("visualization_msgs/MarkerArray[2]", "visualization_msgs/MarkerArray", marker_array_definition, {2, {}});
+
+    return mismatches == 0 ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,133 @@
+// Compares the compiled decoder plan against the original recursive field map walk.
+// The benchmark synthesizes serialized messages from definition strings, so no ROS master is required.
+
+#include "message_introspection/introspector.h"
+#include "definitions.h"
+#include "synthesis.h"
+
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+using namespace message_introspection;
+
+// LEGACY WALK
+/// \brief The original recursive field map walk, kept as the benchmark's baseline.
+void legacy_walk(const definition_tree_t& definition_tree, const uint8_t* bytes, const std::string& current_path, uint32_t& current_position, std::unordered_map<std::string, std::pair<uint32_t, definition_t::primitive_type_t>>& field_map)
+{
+    std::string path = current_path;
+    if(!path.empty())
+    {
+        path += ".";
+    }
+    path += definition_tree.definition.name();
+
+    uint32_t instances = 1;
+    if(definition_tree.definition.array_type() == definition_t::array_type_t::FIXED_LENGTH)
+    {
+        instances = definition_tree.definition.array_length();
+    }
+    else if(definition_tree.definition.array_type() == definition_t::array_type_t::VARIABLE_LENGTH)
+    {
+        instances = le32toh(*reinterpret_cast<const uint32_t*>(&bytes[current_position]));
+        current_position += 4;
+    }
+
+    for(uint32_t i = 0; i < instances; ++i)
+    {
+        std::string instance_path = path;
+        if(definition_tree.definition.is_array())
+        {
+            instance_path += "[" + std::to_string(i) + "]";
+        }
+
+        if(definition_tree.definition.is_primitive())
+        {
+            field_map[instance_path] = {current_position, definition_tree.definition.primitive_type()};
+            if(definition_tree.definition.primitive_type() == definition_t::primitive_type_t::STRING)
+            {
+                current_position += 4 + le32toh(*reinterpret_cast<const uint32_t*>(&bytes[current_position]));
+            }
+            else
+            {
+                current_position += definition_tree.definition.size();
+            }
+        }
+        else
+        {
+            for(auto field = definition_tree.fields.cbegin(); field != definition_tree.fields.cend(); ++field)
+            {
+                legacy_walk(*field, bytes, instance_path, current_position, field_map);
+            }
+        }
+    }
+}
+
+// BENCHMARK
+/// \brief Runs a function repeatedly and returns the mean time per call in nanoseconds.
+template<typename function_t>
+double measure(uint32_t iterations, function_t function)
+{
+    auto start = std::chrono::steady_clock::now();
+    for(uint32_t i = 0; i < iterations; ++i)
+    {
+        function();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+/// \brief Benchmarks a single message shape.
+void run_case(const std::string& name, const std::string& type, const std::string& definition, uint32_t array_length, uint32_t iterations)
+{
+    // Get the definition tree and synthesize a message.
+    introspector message_introspector;
+    message_introspector.new_message_type(type, definition, name);
+    const definition_tree_t& definition_tree = message_introspector.definition_tree();
+    std::vector<uint8_t> bytes;
+    synthesize(definition_tree, {array_length, {}}, bytes);
+
+    // Wrap the message in a ShapeShifter, as it would be received from a subscriber.
+    topic_tools::ShapeShifter message;
+    message.morph(name, type, definition, "0");
+    ros::serialization::IStream stream(bytes.data(), static_cast<uint32_t>(bytes.size()));
+    message.read(stream);
+
+    // Measure the original walk, including the copy of the serialized bytes it required.
+    std::unordered_map<std::string, std::pair<uint32_t, definition_t::primitive_type_t>> field_map;
+    double legacy_ns = measure(iterations, [&]()
+    {
+        uint8_t* copy = new uint8_t[bytes.size()];
+        std::memcpy(copy, bytes.data(), bytes.size());
+        field_map.clear();
+        uint32_t position = 0;
+        legacy_walk(definition_tree, copy, "", position, field_map);
+        delete [] copy;
+    });
+
+    // Measure the compiled plan.
+    double plan_ns = measure(iterations, [&]()
+    {
+        message_introspector.new_message(message);
+    });
+
+    std::cout << std::left << std::setw(36) << (name + "[" + std::to_string(array_length) + "]")
+              << std::right << std::setw(10) << bytes.size() << " B"
+              << std::setw(14) << std::fixed << std::setprecision(0) << legacy_ns << " ns"
+              << std::setw(14) << plan_ns << " ns"
+              << std::setw(10) << std::setprecision(1) << legacy_ns / plan_ns << "x" << std::endl;
+}
+
+int main()
+{
+    std::cout << std::left << std::setw(36) << "message" << std::right << std::setw(12) << "size"
+              << std::setw(17) << "recursive" << std::setw(17) << "plan" << std::setw(11) << "speedup" << std::endl;
+
+    run_case("sensor_msgs/Imu", "sensor_msgs/Imu", imu_definition, 0, 200000);
+    run_case("sensor_msgs/JointState", "sensor_msgs/JointState", joint_state_definition, 12, 100000);
+    run_case("sensor_msgs/JointState", "sensor_msgs/JointState", joint_state_definition, 256, 5000);
+    run_case("visualization_msgs/MarkerArray", "visualization_msgs/MarkerArray", marker_array_definition, 4, 20000);
+    run_case("visualization_msgs/MarkerArray", "visualization_msgs/MarkerArray", marker_array_definition, 64, 500);
+
+    return 0;
+}
\ No newline at end of file
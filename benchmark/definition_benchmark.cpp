@@ -0,0 +1,149 @@
+// Compares the single-pass definition scanner against the original line tokenizer.
+// The original parser is kept here as the baseline. It only builds the component map, while the schema
+// also builds its nodes, layout and decoder plan, so the reported speedup is a lower bound.
+
+#include "message_introspection/schema.h"
+#include "definitions.h"
+
+#include <boost/tokenizer.hpp>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+
+using namespace message_introspection;
+
+// SYNTHESIS
+/// \brief Creates a definition with many component types, referenced by their short names.
+/// \param n_types The number of component types.
+/// \returns The definition string.
+std::string synthesize_definition(uint32_t n_types)
+{
+    std::string definition;
+    for(uint32_t i = 0; i < n_types; ++i)
+    {
+        definition += "Component" + std::to_string(i) + " component_" + std::to_string(i) + "\n";
+    }
+    for(uint32_t i = 0; i < n_types; ++i)
+    {
+        definition += "================================================================================\n";
+        definition += "MSG: synthetic_msgs/Component" + std::to_string(i) + "\n";
+        definition += "float64 x\nfloat64 y\nstring label\nuint8[] data\n";
+    }
+    return definition;
+}
+
+// LEGACY PARSER
+/// \brief The original component parser, kept as the benchmark's baseline.
+void legacy_parse(std::string message_type, std::string definition, std::unordered_map<std::string, std::vector<definition_t>>& components)
+{
+    auto* fields_workspace = &components[message_type];
+    std::stringstream description_stream(definition);
+    boost::char_separator<char> delimiter(" ");
+    std::string current_line;
+    while(std::getline(description_stream, current_line))
+    {
+        auto comment_position = current_line.find_first_of('#');
+        if(comment_position != std::string::npos)
+        {
+            current_line.erase(comment_position);
+        }
+        if(current_line.empty() || current_line.find_first_of('=') != std::string::npos)
+        {
+            continue;
+        }
+        boost::tokenizer<boost::char_separator<char>> tokenizer(current_line, delimiter);
+        std::vector<std::string> tokens(tokenizer.begin(), tokenizer.end());
+        if(tokens.empty())
+        {
+            continue;
+        }
+        if(tokens[0].compare("MSG:") == 0)
+        {
+            fields_workspace = &components[tokens[1]];
+        }
+        else
+        {
+            auto array_position = tokens[0].find_first_of('[');
+            std::string type = tokens[0];
+            std::string array = "";
+            if(array_position != std::string::npos)
+            {
+                array = tokens[0].substr(array_position);
+                type.erase(array_position);
+            }
+            fields_workspace->push_back(definition_t(type, array, tokens[1]));
+        }
+    }
+    for(auto definition = components.begin(); definition != components.end(); ++definition)
+    {
+        auto& fields = definition->second;
+        for(auto field = fields.begin(); field != fields.end(); ++field)
+        {
+            if(field->is_primitive() || components.count(field->type()) != 0)
+            {
+                continue;
+            }
+            for(auto candidate = components.begin(); candidate != components.end(); ++candidate)
+            {
+                if(candidate->first.find(field->type()) != std::string::npos)
+                {
+                    field->update_type(candidate->first);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+// BENCHMARK
+/// \brief Runs a function repeatedly and returns the mean time per call in nanoseconds.
+template<typename function_t>
+double measure(uint32_t iterations, function_t function)
+{
+    auto start = std::chrono::steady_clock::now();
+    for(uint32_t i = 0; i < iterations; ++i)
+    {
+        function();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+/// \brief Benchmarks a single definition.
+void run_case(const std::string& name, const std::string& type, const std::string& definition, uint32_t iterations)
+{
+    // Measure the original component parser alone.
+    double legacy_ns = measure(iterations, [&]()
+    {
+        std::unordered_map<std::string, std::vector<definition_t>> components;
+        legacy_parse(type, definition, components);
+    });
+
+    // Measure the creation of a complete schema.
+    double schema_ns = measure(iterations, [&]()
+    {
+        schema_t schema("", type, definition);
+    });
+
+    std::cout << std::left << std::setw(36) << name
+              << std::right << std::setw(10) << definition.size() << " B"
+              << std::setw(14) << std::fixed << std::setprecision(0) << legacy_ns << " ns"
+              << std::setw(14) << schema_ns << " ns"
+              << std::setw(10) << std::setprecision(1) << legacy_ns / schema_ns << "x" << std::endl;
+}
+
+int main()
+{
+    std::cout << std::left << std::setw(36) << "definition" << std::right << std::setw(12) << "size"
+              << std::setw(17) << "legacy parse" << std::setw(17) << "schema" << std::setw(11) << "speedup" << std::endl;
+
+    run_case("sensor_msgs/Imu", "sensor_msgs/Imu", imu_definition, 20000);
+    run_case("sensor_msgs/JointState", "sensor_msgs/JointState", joint_state_definition, 20000);
+    run_case("visualization_msgs/MarkerArray", "visualization_msgs/MarkerArray", marker_array_definition, 10000);
+    run_case("synthetic_msgs/Large[64]", "synthetic_msgs/Large", synthesize_definition(64), 500);
+    run_case("synthetic_msgs/Large[512]", "synthetic_msgs/Large", synthesize_definition(512), 20);
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,104 @@
+// Message definitions shared by the benchmarks.
+#ifndef MESSAGE_INTROSPECTION___BENCHMARK_DEFINITIONS_H
+#define MESSAGE_INTROSPECTION___BENCHMARK_DEFINITIONS_H
+
+#include <string>
+
+// DEFINITIONS
+const std::string header_definition =
+    "================================================================================\n"
+    "MSG: std_msgs/Header\n"
+    "uint32 seq\n"
+    "time stamp\n"
+    "string frame_id\n";
+const std::string imu_definition =
+    "Header header\n"
+    "geometry_msgs/Quaternion orientation\n"
+    "float64[9] orientation_covariance\n"
+    "geometry_msgs/Vector3 angular_velocity\n"
+    "float64[9] angular_velocity_covariance\n"
+    "geometry_msgs/Vector3 linear_acceleration\n"
+    "float64[9] linear_acceleration_covariance\n"
+    + header_definition +
+    "================================================================================\n"
+    "MSG: geometry_msgs/Quaternion\n"
+    "float64 x\nfloat64 y\nfloat64 z\nfloat64 w\n"
+    "================================================================================\n"
+    "MSG: geometry_msgs/Vector3\n"
+    "float64 x\nfloat64 y\nfloat64 z\n";
+const std::string joint_state_definition =
+    "Header header\n"
+    "string[] name\n"
+    "float64[] position\n"
+    "float64[] velocity\n"
+    "float64[] effort\n"
+    + header_definition;
+const std::string laser_scan_definition =
+    "Header header\n"
+    "float32 angle_min\n"
+    "float32 angle_max\n"
+    "float32 angle_increment\n"
+    "float32 time_increment\n"
+    "float32 scan_time\n"
+    "float32 range_min\n"
+    "float32 range_max\n"
+    "float32[] ranges\n"
+    "float32[] intensities\n"
+    + header_definition;
+const std::string point_cloud_definition =
+    "Header header\n"
+    "uint32 height\n"
+    "uint32 width\n"
+    "PointField[] fields\n"
+    "bool is_bigendian\n"
+    "uint32 point_step\n"
+    "uint32 row_step\n"
+    "uint8[] data\n"
+    "bool is_dense\n"
+    + header_definition +
+    "================================================================================\n"
+    "MSG: sensor_msgs/PointField\n"
+    "uint8 INT8    = 1\n"
+    "uint8 FLOAT32 = 7\n"
+    "string name\n"
+    "uint32 offset\n"
+    "uint8 datatype\n"
+    "uint32 count\n";
+const std::string marker_array_definition =
+    "visualization_msgs/Marker[] markers\n"
+    "================================================================================\n"
+    "MSG: visualization_msgs/Marker\n"
+    "Header header\n"
+    "string ns\n"
+    "int32 id\n"
+    "int32 type\n"
+    "int32 action\n"
+    "geometry_msgs/Pose pose\n"
+    "geometry_msgs/Vector3 scale\n"
+    "std_msgs/ColorRGBA color\n"
+    "duration lifetime\n"
+    "bool frame_locked\n"
+    "geometry_msgs/Point[] points\n"
+    "std_msgs/ColorRGBA[] colors\n"
+    "string text\n"
+    "string mesh_resource\n"
+    "bool mesh_use_embedded_materials\n"
+    + header_definition +
+    "================================================================================\n"
+    "MSG: geometry_msgs/Pose\n"
+    "geometry_msgs/Point position\n"
+    "geometry_msgs/Quaternion orientation\n"
+    "================================================================================\n"
+    "MSG: geometry_msgs/Point\n"
+    "float64 x\nfloat64 y\nfloat64 z\n"
+    "================================================================================\n"
+    "MSG: geometry_msgs/Quaternion\n"
+    "float64 x\nfloat64 y\nfloat64 z\nfloat64 w\n"
+    "================================================================================\n"
+    "MSG: geometry_msgs/Vector3\n"
+    "float64 x\nfloat64 y\nfloat64 z\n"
+    "================================================================================\n"
+    "MSG: std_msgs/ColorRGBA\n"
+    "float32 r\nfloat32 g\nfloat32 b\nfloat32 a\n";
+
+#endif
\ No newline at end of file
@@ -0,0 +1,542 @@
+// Measures the time and memory allocated by each of the introspector's hot paths.
+// The benchmark synthesizes serialized messages from definition strings, so no ROS master is required.
+// Every operation reports its mean time, and the mean number and size of heap allocations per call, so
+// regressions in registration, parsing, field access and printing are visible.
+
+#include "message_introspection/introspector.h"
+#include "message_introspection/message_filter.h"
+#include "message_introspection/registry.h"
+#include "definitions.h"
+#include "synthesis.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+
+using namespace message_introspection;
+
+// ALLOCATION TRACKING
+/// \brief Counts the heap allocations made by the process.
+static uint64_t s_allocations = 0;
+/// \brief Counts the bytes allocated on the heap by the process.
+static uint64_t s_allocated_bytes = 0;
+void* operator new(size_t size)
+{
+    ++s_allocations;
+    s_allocated_bytes += size;
+    void* memory = std::malloc(size != 0 ? size : 1);
+    if(memory == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+// Deallocation is not inlined, so the compiler does not mistake freeing new's memory for a mismatch.
+__attribute__((noinline)) void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+__attribute__((noinline)) void operator delete(void* memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+// BENCHMARK
+/// \brief The result of measuring an operation.
+struct result_t
+{
+    /// \brief The mean time per call in nanoseconds.
+    double ns;
+    /// \brief The mean number of heap allocations per call.
+    double allocations;
+    /// \brief The mean number of bytes allocated per call.
+    double bytes;
+};
+/// \brief Runs a function repeatedly and measures it.
+/// \details The number of calls is doubled until the calls take at least 20 ms, so fast and slow operations
+/// are both measured accurately.
+template<typename function_t>
+result_t measure(function_t function)
+{
+    // Warm up any caches and buffers used by the operation.
+    function();
+
+    for(uint64_t iterations = 1; ; iterations *= 2)
+    {
+        uint64_t allocations = s_allocations;
+        uint64_t allocated_bytes = s_allocated_bytes;
+        auto start = std::chrono::steady_clock::now();
+        for(uint64_t i = 0; i < iterations; ++i)
+        {
+            function();
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        if(elapsed >= std::chrono::milliseconds(20) || iterations >= (1ull << 30))
+        {
+            result_t result;
+            result.ns = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+            result.allocations = static_cast<double>(s_allocations - allocations) / iterations;
+            result.bytes = static_cast<double>(s_allocated_bytes - allocated_bytes) / iterations;
+            return result;
+        }
+    }
+}
+/// \brief Prints the result of an operation.
+void report(const std::string& operation, const result_t& result)
+{
+    std::cout << "  " << std::left << std::setw(44) << operation
+              << std::right << std::fixed << std::setprecision(1) << std::setw(14) << result.ns << " ns/op"
+              << std::setw(10) << std::setprecision(2) << result.allocations << " allocs/op"
+              << std::setw(14) << std::setprecision(0) << result.bytes << " B/op" << std::endl;
+}
+
+// ACCESSORS
+/// \brief Reads a field with the typed getter that matches its primitive type.
+/// \param introspector The introspector to read from.
+/// \param key The field's path or handle.
+/// \param primitive_type The field's primitive type.
+/// \returns The name of the getter that was used.
+template<typename key_t>
+const char* read_typed(const introspector& introspector, const key_t& key, definition_t::primitive_type_t primitive_type)
+{
+    switch(primitive_type)
+    {
+        case definition_t::primitive_type_t::BOOL:
+        {
+            bool value;
+            introspector.get_bool(key, value);
+            return "get_bool";
+        }
+        case definition_t::primitive_type_t::INT8:
+        {
+            int8_t value;
+            introspector.get_int8(key, value);
+            return "get_int8";
+        }
+        case definition_t::primitive_type_t::INT16:
+        {
+            int16_t value;
+            introspector.get_int16(key, value);
+            return "get_int16";
+        }
+        case definition_t::primitive_type_t::INT32:
+        {
+            int32_t value;
+            introspector.get_int32(key, value);
+            return "get_int32";
+        }
+        case definition_t::primitive_type_t::INT64:
+        {
+            int64_t value;
+            introspector.get_int64(key, value);
+            return "get_int64";
+        }
+        case definition_t::primitive_type_t::UINT8:
+        {
+            uint8_t value;
+            introspector.get_uint8(key, value);
+            return "get_uint8";
+        }
+        case definition_t::primitive_type_t::UINT16:
+        {
+            uint16_t value;
+            introspector.get_uint16(key, value);
+            return "get_uint16";
+        }
+        case definition_t::primitive_type_t::UINT32:
+        {
+            uint32_t value;
+            introspector.get_uint32(key, value);
+            return "get_uint32";
+        }
+        case definition_t::primitive_type_t::UINT64:
+        {
+            uint64_t value;
+            introspector.get_uint64(key, value);
+            return "get_uint64";
+        }
+        case definition_t::primitive_type_t::FLOAT32:
+        {
+            float value;
+            introspector.get_float32(key, value);
+            return "get_float32";
+        }
+        case definition_t::primitive_type_t::FLOAT64:
+        {
+            double value;
+            introspector.get_float64(key, value);
+            return "get_float64";
+        }
+        case definition_t::primitive_type_t::STRING:
+        {
+            std::string value;
+            introspector.get_string(key, value);
+            return "get_string";
+        }
+        case definition_t::primitive_type_t::TIME:
+        {
+            ros::Time value;
+            introspector.get_time(key, value);
+            return "get_time";
+        }
+        case definition_t::primitive_type_t::DURATION:
+        {
+            ros::Duration value;
+            introspector.get_duration(key, value);
+            return "get_duration";
+        }
+        case definition_t::primitive_type_t::NON_PRIMITIVE:
+        {
+            break;
+        }
+    }
+    return "";
+}
+/// \brief Reads a whole array of fixed size primitives as a span.
+template<typename T>
+void read_span(const introspector& introspector, const std::string& path)
+{
+    span_t<T> values;
+    introspector.get_array(path, values);
+}
+/// \brief Reads a whole array of fixed size primitives as a span of its primitive type.
+/// \param introspector The introspector to read from.
+/// \param path The array's path.
+/// \param primitive_type The array's primitive type.
+void read_array(const introspector& introspector, const std::string& path, definition_t::primitive_type_t primitive_type)
+{
+    switch(primitive_type)
+    {
+        case definition_t::primitive_type_t::BOOL: read_span<bool>(introspector, path); break;
+        case definition_t::primitive_type_t::INT8: read_span<int8_t>(introspector, path); break;
+        case definition_t::primitive_type_t::INT16: read_span<int16_t>(introspector, path); break;
+        case definition_t::primitive_type_t::INT32: read_span<int32_t>(introspector, path); break;
+        case definition_t::primitive_type_t::INT64: read_span<int64_t>(introspector, path); break;
+        case definition_t::primitive_type_t::UINT8: read_span<uint8_t>(introspector, path); break;
+        case definition_t::primitive_type_t::UINT16: read_span<uint16_t>(introspector, path); break;
+        case definition_t::primitive_type_t::UINT32: read_span<uint32_t>(introspector, path); break;
+        case definition_t::primitive_type_t::UINT64: read_span<uint64_t>(introspector, path); break;
+        case definition_t::primitive_type_t::FLOAT32: read_span<float>(introspector, path); break;
+        case definition_t::primitive_type_t::FLOAT64: read_span<double>(introspector, path); break;
+        default: break;
+    }
+}
+
+// FIELD SELECTION
+/// \brief A field selected for measuring an accessor.
+struct field_sample_t
+{
+    /// \brief The field's path, using the first element of any arrays.
+    std::string path;
+    /// \brief The field's primitive type.
+    definition_t::primitive_type_t primitive_type;
+};
+/// \brief Selects the first field of each primitive type, and the largest array of fixed size primitives.
+/// \param definition_tree The definition tree to search.
+/// \param path The path of the definition tree.
+/// \param fields The first field of each primitive type, indexed by primitive type.
+/// \param array The whole array to read, if any.
+/// \param array_size The serialized size of an element of the selected array times its number of elements.
+/// \param array_lengths The number of elements used for variable length arrays.
+void select_fields(const definition_tree_t& definition_tree, const std::string& path, std::vector<field_sample_t>& fields, field_sample_t& array, uint64_t& array_size, const array_lengths_t& array_lengths)
+{
+    const definition_t& definition = definition_tree.definition;
+    std::string element_path = path;
+    if(definition.is_array())
+    {
+        // Consider the whole array, which is read in one call if its elements are fixed size primitives.
+        uint32_t length = definition.array_length();
+        if(definition.array_type() == definition_t::array_type_t::VARIABLE_LENGTH)
+        {
+            auto named_length = array_lengths.lengths.find(definition.name());
+            length = (named_length != array_lengths.lengths.end()) ? named_length->second : array_lengths.default_length;
+        }
+        if(definition.is_primitive() && definition.is_fixed_size() && static_cast<uint64_t>(length) * definition.size() > array_size)
+        {
+            array = {path, definition.primitive_type()};
+            array_size = static_cast<uint64_t>(length) * definition.size();
+        }
+        element_path += "[0]";
+    }
+
+    if(definition.is_primitive())
+    {
+        field_sample_t& field = fields[static_cast<uint32_t>(definition.primitive_type())];
+        if(field.path.empty())
+        {
+            field = {element_path, definition.primitive_type()};
+        }
+        return;
+    }
+    for(auto field = definition_tree.fields.cbegin(); field != definition_tree.fields.cend(); ++field)
+    {
+        select_fields(*field, element_path.empty() ? field->definition.name() : element_path + "." + field->definition.name(), fields, array, array_size, array_lengths);
+    }
+}
+
+// CASES
+/// \brief Benchmarks every hot path on a single message shape.
+void run_case(const std::string& name, const std::string& type, const std::string& definition, const array_lengths_t& array_lengths)
+{
+    std::string md5 = type + "_md5";
+
+    // Get the definition tree and synthesize a message.
+    introspector message_introspector;
+    message_introspector.new_message_type(type, definition, md5);
+    std::vector<uint8_t> bytes;
+    synthesize(message_introspector.definition_tree(), array_lengths, bytes);
+
+    // Wrap the message in a ShapeShifter, as it would be received from a subscriber.
+    topic_tools::ShapeShifter message;
+    message.morph(md5, type, definition, "0");
+    ros::serialization::IStream stream(bytes.data(), static_cast<uint32_t>(bytes.size()));
+    message.read(stream);
+
+    std::cout << name << " (" << bytes.size() << " B)" << std::endl;
+
+    // REGISTRATION
+    // A cold registration parses the definition, since the registry and the introspector's cache are empty.
+    report("new_message_type (cold)", measure([&]()
+    {
+        registry::clear();
+        introspector cold_introspector;
+        cold_introspector.new_message_type(type, definition, md5);
+    }));
+    report("new_message_type (cached)", measure([&]()
+    {
+        message_introspector.new_message_type(type, definition, md5);
+    }));
+
+    // PARSING
+    report("new_message (ShapeShifter)", measure([&]()
+    {
+        message_introspector.new_message(message);
+    }));
+    report("new_message (copied bytes)", measure([&]()
+    {
+        message_introspector.new_message(bytes.data(), bytes.size(), md5, type, definition);
+    }));
+    report("new_message (borrowed bytes)", measure([&]()
+    {
+        message_introspector.new_message(bytes.data(), bytes.size(), md5, type, definition, true);
+    }));
+
+    // FIELD ACCESS
+    // Each field is read from the same message, so these measure reads after the message's first read.
+    std::vector<field_sample_t> fields(static_cast<uint32_t>(definition_t::primitive_type_t::DURATION) + 1, {"", definition_t::primitive_type_t::NON_PRIMITIVE});
+    field_sample_t array = {"", definition_t::primitive_type_t::NON_PRIMITIVE};
+    uint64_t array_size = 0;
+    select_fields(message_introspector.definition_tree(), "", fields, array, array_size, array_lengths);
+    for(auto field = fields.cbegin(); field != fields.cend(); ++field)
+    {
+        if(field->path.empty())
+        {
+            continue;
+        }
+
+        // Read the field by path, by handle, and as a number.
+        const char* getter = read_typed(message_introspector, field->path, field->primitive_type);
+        report(std::string(getter) + "(" + field->path + ")", measure([&]()
+        {
+            read_typed(message_introspector, field->path, field->primitive_type);
+        }));
+        field_handle_t handle;
+        message_introspector.get_handle(field->path, handle);
+        report(std::string(getter) + "(handle)", measure([&]()
+        {
+            read_typed(message_introspector, handle, field->primitive_type);
+        }));
+        report("get_number(" + field->path + ")", measure([&]()
+        {
+            double value;
+            message_introspector.get_number(field->path, value);
+        }));
+    }
+    if(!array.path.empty())
+    {
+        report("get_array(" + array.path + ")", measure([&]()
+        {
+            read_array(message_introspector, array.path, array.primitive_type);
+        }));
+    }
+    report("path_exists", measure([&]()
+    {
+        message_introspector.path_exists(fields[static_cast<uint32_t>(definition_t::primitive_type_t::UINT32)].path);
+    }));
+
+    // Read a field from each new message.
+    // The messages have the same shape, so the index and the field's position are kept from the first message.
+    field_handle_t first_handle;
+    for(auto field = fields.crbegin(); field != fields.crend(); ++field)
+    {
+        if(!field->path.empty())
+        {
+            message_introspector.get_handle(field->path, first_handle);
+        }
+    }
+    report("new_message + get_number(handle)", measure([&]()
+    {
+        message_introspector.new_message(bytes.data(), bytes.size(), md5, type, definition, true);
+        double value;
+        message_introspector.get_number(first_handle, value);
+    }));
+
+    // Alternate between messages of two shapes, so each message is indexed and the field is positioned again.
+    array_lengths_t changed_lengths = array_lengths;
+    ++changed_lengths.default_length;
+    std::vector<uint8_t> changed_bytes;
+    synthesize(message_introspector.definition_tree(), changed_lengths, changed_bytes);
+    if(changed_bytes.size() != bytes.size())
+    {
+        bool changed = false;
+        report("new_message + get_number(handle), new shape", measure([&]()
+        {
+            changed = !changed;
+            const std::vector<uint8_t>& current = changed ? changed_bytes : bytes;
+            message_introspector.new_message(current.data(), current.size(), md5, type, definition, true);
+            double value;
+            message_introspector.get_number(first_handle, value);
+        }));
+    }
+
+    // Read a field of the first top level field from each new message, with an interest set that ends the index there.
+    const std::string& first_name = message_introspector.definition_tree().fields.front().definition.name();
+    for(auto field = fields.cbegin(); field != fields.cend(); ++field)
+    {
+        if(field->path.compare(0, first_name.size(), first_name) != 0)
+        {
+            continue;
+        }
+        field_handle_t interest_handle;
+        message_introspector.get_handle(field->path, interest_handle);
+        message_introspector.set_interest({first_name});
+        report("new_message + get_number(handle), interest", measure([&]()
+        {
+            message_introspector.new_message(bytes.data(), bytes.size(), md5, type, definition, true);
+            double value;
+            message_introspector.get_number(interest_handle, value);
+        }));
+        message_introspector.set_interest({});
+        break;
+    }
+
+    // Convert every selected field of each new message, one at a time and as a batch.
+    std::vector<field_handle_t> handles;
+    for(auto field = fields.cbegin(); field != fields.cend(); ++field)
+    {
+        if(!field->path.empty())
+        {
+            handles.emplace_back();
+            message_introspector.get_handle(field->path, handles.back());
+        }
+    }
+    std::vector<double> values(handles.size());
+    report("new_message + get_number(handle) x" + std::to_string(handles.size()), measure([&]()
+    {
+        message_introspector.new_message(bytes.data(), bytes.size(), md5, type, definition, true);
+        for(size_t h = 0; h < handles.size(); ++h)
+        {
+            message_introspector.get_number(handles[h], values[h]);
+        }
+    }));
+    report("new_message + get_numbers(" + std::to_string(handles.size()) + " handles)", measure([&]()
+    {
+        message_introspector.new_message(bytes.data(), bytes.size(), md5, type, definition, true);
+        message_introspector.get_numbers(handles, values.data());
+    }));
+
+    // Read a field of every element of an array, with a wildcard query and with a path for each element.
+    for(auto field = fields.cbegin(); field != fields.cend(); ++field)
+    {
+        size_t index_position = field->path.find("[0]");
+        if(index_position == std::string::npos || field->path.find("[0]", index_position + 1) != std::string::npos)
+        {
+            continue;
+        }
+        std::string prefix = field->path.substr(0, index_position);
+        std::string suffix = field->path.substr(index_position + 3);
+        field_query_t query;
+        message_introspector.get_query(prefix + "[*]" + suffix, query);
+        std::vector<double> query_values;
+        message_introspector.get_numbers(query, query_values);
+        uint32_t n_elements = static_cast<uint32_t>(query_values.size());
+        report("get_numbers(" + query.path() + ") x" + std::to_string(n_elements), measure([&]()
+        {
+            message_introspector.get_numbers(query, query_values);
+        }));
+        report("get_number(" + prefix + "[i]" + suffix + ") x" + std::to_string(n_elements), measure([&]()
+        {
+            for(uint32_t i = 0; i < n_elements; ++i)
+            {
+                message_introspector.get_number(prefix + "[" + std::to_string(i) + "]" + suffix, query_values[i]);
+            }
+        }));
+        break;
+    }
+
+    // FILTERING
+    // Filter each new message on a number and a string, as a bag triage tool would.
+    // The rejecting filter fails on the number, so it never reads the string.
+    const std::string& number_path = fields[static_cast<uint32_t>(definition_t::primitive_type_t::UINT32)].path;
+    const std::string& string_path = fields[static_cast<uint32_t>(definition_t::primitive_type_t::STRING)].path;
+    if(!number_path.empty() && !string_path.empty())
+    {
+        uint32_t number;
+        std::string text;
+        message_introspector.get_uint32(number_path, number);
+        message_introspector.get_string(string_path, text);
+        std::string condition = string_path + " == \"" + text + "\"";
+        message_filter rejecting(number_path + " == " + std::to_string(number + 1) + " && " + condition);
+        message_filter accepting(number_path + " == " + std::to_string(number) + " && " + condition);
+
+        // Messages are only indexed up to the filtered fields.
+        introspector filter_introspector;
+        filter_introspector.set_lazy(true);
+        filter_introspector.set_interest(accepting.paths());
+        report("new_message + message_filter, reject", measure([&]()
+        {
+            filter_introspector.new_message(bytes.data(), bytes.size(), md5, type, definition, true);
+            rejecting.matches(filter_introspector);
+        }));
+        report("new_message + message_filter, accept", measure([&]()
+        {
+            filter_introspector.new_message(bytes.data(), bytes.size(), md5, type, definition, true);
+            accepting.matches(filter_introspector);
+        }));
+
+        // Compare with reading the fields by path and testing them in user code.
+        uint32_t message_number;
+        std::string message_text;
+        report("new_message + get_uint32 + get_string, accept", measure([&]()
+        {
+            filter_introspector.new_message(bytes.data(), bytes.size(), md5, type, definition, true);
+            filter_introspector.get_uint32(number_path, message_number) && message_number == number && filter_introspector.get_string(string_path, message_text) && message_text == text;
+        }));
+    }
+
+    // PRINTING
+    report("print_definition_tree", measure([&]()
+    {
+        message_introspector.print_definition_tree();
+    }));
+
+    std::cout << std::endl;
+}
+
+int main()
+{
+    run_case("sensor_msgs/Imu", "sensor_msgs/Imu", imu_definition, {0, {}});
+    run_case("sensor_msgs/JointState[12]", "sensor_msgs/JointState", joint_state_definition, {12, {}});
+    run_case("sensor_msgs/LaserScan[720]", "sensor_msgs/LaserScan", laser_scan_definition, {720, {}});
+    run_case("sensor_msgs/PointCloud2[640x480]", "sensor_msgs/PointCloud2", point_cloud_definition, {0, {{"fields", 4}, {"data", 640 * 480 * 16}}});
+    run_case("visualization_msgs/MarkerArray[16]", "visualization_msgs/MarkerArray", marker_array_definition, {16, {}});
+
+    // Pathological shapes: many variable sized elements, and large nested arrays.
+    run_case("sensor_msgs/JointState[100000]", "sensor_msgs/JointState", joint_state_definition, {100000, {}});
+    run_case("visualization_msgs/MarkerArray[512x512]", "visualization_msgs/MarkerArray", marker_array_definition, {512, {}});
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+// Synthesizes serialized messages from definition trees, so the benchmarks do not require a ROS master.
+#ifndef MESSAGE_INTROSPECTION___BENCHMARK_SYNTHESIS_H
+#define MESSAGE_INTROSPECTION___BENCHMARK_SYNTHESIS_H
+
+#include "message_introspection/definition_tree.h"
+
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// SYNTHESIS
+/// \brief Specifies the number of elements to synthesize for variable length arrays.
+struct array_lengths_t
+{
+    /// \brief The number of elements for arrays that are not listed by name.
+    uint32_t default_length;
+    /// \brief The number of elements for specific arrays, keyed by field name.
+    std::unordered_map<std::string, uint32_t> lengths;
+};
+/// \brief Appends a little endian value to a serialized message.
+template<typename T>
+inline void append_value(std::vector<uint8_t>& bytes, T value)
+{
+    uint8_t raw[sizeof(T)];
+    std::memcpy(raw, &value, sizeof(T));
+    bytes.insert(bytes.end(), raw, raw + sizeof(T));
+}
+/// \brief Appends a synthetic instance of a definition tree to a serialized message.
+/// \param definition_tree The definition tree to synthesize.
+/// \param array_lengths The number of elements to use for variable length arrays.
+/// \param bytes The serialized message to append to.
+inline void synthesize(const message_introspection::definition_tree_t& definition_tree, const array_lengths_t& array_lengths, std::vector<uint8_t>& bytes)
+{
+    using message_introspection::definition_t;
+    const definition_t& definition = definition_tree.definition;
+
+    // Determine the number of instances, writing the length of variable length arrays.
+    uint32_t instances = 1;
+    if(definition.array_type() == definition_t::array_type_t::FIXED_LENGTH)
+    {
+        instances = definition.array_length();
+    }
+    else if(definition.array_type() == definition_t::array_type_t::VARIABLE_LENGTH)
+    {
+        auto length = array_lengths.lengths.find(definition.name());
+        instances = (length != array_lengths.lengths.end()) ? length->second : array_lengths.default_length;
+        append_value<uint32_t>(bytes, instances);
+    }
+
+    for(uint32_t i = 0; i < instances; ++i)
+    {
+        if(definition.primitive_type() == definition_t::primitive_type_t::STRING)
+        {
+            std::string value = definition.name() + "_" + std::to_string(i);
+            append_value<uint32_t>(bytes, value.size());
+            bytes.insert(bytes.end(), value.begin(), value.end());
+        }
+        else if(definition.is_primitive())
+        {
+            bytes.insert(bytes.end(), definition.size(), static_cast<uint8_t>(i));
+        }
+        else
+        {
+            for(auto field = definition_tree.fields.cbegin(); field != definition_tree.fields.cend(); ++field)
+            {
+                synthesize(*field, array_lengths, bytes);
+            }
+        }
+    }
+}
+
+#endif
\ No newline at end of file
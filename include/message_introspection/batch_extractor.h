@@ -0,0 +1,133 @@
+/// \file message_introspection/batch_extractor.h
+/// \brief Defines the message_introspection::batch_extractor class.
+#ifndef MESSAGE_INTROSPECTION___BATCH_EXTRACTOR_H
+#define MESSAGE_INTROSPECTION___BATCH_EXTRACTOR_H
+
+#include "message_introspection/introspector.h"
+#include "message_introspection/field_handle.h"
+
+#include <rosbag/view.h>
+#include <rosbag/message_instance.h>
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace message_introspection {
+
+/// \brief Extracts selected fields from many bag messages into columns.
+/// \details The extractor reads a fixed list of paths from each message and appends one row per message.
+/// Each path becomes a column of values and a column of validity flags, alongside a shared column of
+/// bag timestamps. Paths are resolved to field handles once per message type, and the messages, index
+/// and columns reuse their storage, so a steady stream of messages is extracted without allocating memory
+/// beyond the growth of the columns themselves.
+class batch_extractor
+{
+public:
+    // CONSTRUCTORS
+    /// \brief Creates a new batch extractor.
+    /// \param paths The paths of the fields to extract. Each path becomes a column.
+    batch_extractor(const std::vector<std::string>& paths);
+    // The extractor points into its own resolutions and owns an introspector, so it is not copied.
+    batch_extractor(const batch_extractor&) = delete;
+    batch_extractor& operator=(const batch_extractor&) = delete;
+
+    // EXTRACT
+    /// \brief Extracts a row from every message in a bag view.
+    /// \param view The view to extract from.
+    /// \returns The number of rows added.
+    uint32_t extract(rosbag::View& view);
+    /// \brief Extracts a row from every message in a range.
+    /// \tparam iterator_t An iterator over rosbag::MessageInstance objects.
+    /// \param begin The first message of the range.
+    /// \param end The end of the range.
+    /// \returns The number of rows added.
+    template<typename iterator_t>
+    uint32_t extract(iterator_t begin, iterator_t end)
+    {
+        uint32_t n_rows = 0;
+        for(; begin != end; ++begin)
+        {
+            batch_extractor::add_message(*begin);
+            ++n_rows;
+        }
+        return n_rows;
+    }
+    /// \brief Extracts a row from a single message.
+    /// \param message The message to extract from.
+    void add_message(const rosbag::MessageInstance& message);
+
+    // COLUMNS
+    /// \brief Gets the number of columns.
+    /// \returns The number of columns, which is the number of paths.
+    uint32_t n_columns() const;
+    /// \brief Gets the number of rows.
+    /// \returns The number of rows, which is the number of messages extracted.
+    size_t n_rows() const;
+    /// \brief Gets the path of a column.
+    /// \param column The index of the column.
+    /// \returns The column's path.
+    const std::string& path(uint32_t column) const;
+    /// \brief Gets the bag timestamp of each row.
+    /// \returns The timestamps column.
+    const std::vector<ros::Time>& stamps() const;
+    /// \brief Gets the values of a column.
+    /// \param column The index of the column.
+    /// \returns The column's values. Rows whose field could not be read are NaN.
+    /// \details Values are converted to double as described in introspector::get_number().
+    const std::vector<double>& values(uint32_t column) const;
+    /// \brief Gets the validity flags of a column.
+    /// \param column The index of the column.
+    /// \returns The column's validity flags, which are 1 if the row's field was read, otherwise 0.
+    const std::vector<uint8_t>& valid(uint32_t column) const;
+
+    // STORAGE
+    /// \brief Reserves storage for a number of rows in every column.
+    /// \param n_rows The total number of rows to reserve storage for.
+    void reserve(size_t n_rows);
+    /// \brief Removes all rows.
+    /// \details The columns keep their storage, so they can be filled again without allocating memory.
+    void clear();
+
+private:
+    // COLUMNS
+    /// \brief Stores the paths of the columns.
+    std::vector<std::string> m_paths;
+    /// \brief Stores the bag timestamp of each row.
+    std::vector<ros::Time> m_stamps;
+    /// \brief Stores the values of each column.
+    std::vector<std::vector<double>> m_values;
+    /// \brief Stores the validity flags of each column.
+    std::vector<std::vector<uint8_t>> m_valid;
+    /// \brief Stores the values of the row being added.
+    std::vector<double> m_row_values;
+    /// \brief Stores the validity flags of the row being added.
+    std::vector<uint8_t> m_row_valid;
+
+    // HANDLES
+    /// \brief The introspector that reads each message.
+    introspector m_introspector;
+    /// \brief The field handles of each column resolved against a message type.
+    struct resolution_t
+    {
+        /// \brief The handles of each column, which are unresolved if a column's path does not exist.
+        std::vector<field_handle_t> handles;
+        /// \brief The index of a resolved handle, which identifies the message type, or the number of handles if there is none.
+        uint32_t probe;
+    };
+    /// \brief Stores the resolutions of each message type, keyed by schema ID.
+    std::unordered_map<uint64_t, resolution_t> m_resolutions;
+    /// \brief Points to the resolution of the most recent message type.
+    const resolution_t* m_current_resolution;
+    /// \brief Stores unresolved handles for each column, which are read if the introspector holds no message type.
+    std::vector<field_handle_t> m_unresolved;
+    /// \brief Gets the field handles of the current message's type, resolving them if the type is new.
+    /// \returns The field handles of each column.
+    /// \details Types are identified by schema ID, so a type that is parsed again after registry::clear() or
+    /// schema cache eviction is resolved again rather than read with stale handles.
+    const std::vector<field_handle_t>& get_handles();
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -52,7 +52,7 @@ public:
     // TYPE
     /// \brief Gets the type string of the definition.
     /// \returns The type as a string.
-    std::string type() const;
+    const std::string& type() const;
     /// \brief Indicates if the definition is a primitive type.
     /// \returns TRUE if the definition is a primitive type, otherwise FALSE.
     bool is_primitive() const;
@@ -62,11 +62,19 @@ public:
     /// \brief Gets the size of the definition in bytes.
     /// \returns The size of the definition.
     uint32_t size() const;
+    /// \brief Indicates if the definition's serialized size is the same for every message instance.
+    /// \returns TRUE if the definition contains no strings or variable length arrays, otherwise FALSE.
+    /// \note For arrays, this refers to the size of a single element.
+    bool is_fixed_size() const;
+    /// \brief Gets the serialized size of a single instance of the definition in bytes.
+    /// \returns The serialized size, which is only valid if the definition has a fixed size.
+    /// \note Unlike size(), this includes every element of the definition's fixed length array fields.
+    uint32_t serialized_size() const;
 
     // ARRAY
     /// \brief Gets the array type as a string.
     /// \returns The array type.
-    std::string array() const;
+    const std::string& array() const;
     /// \brief Indicates if the definition is an array.
     /// \returns TRUE if the definition is an array, otherwise FALSE.
     bool is_array() const;
@@ -80,12 +88,12 @@ public:
     // NAME
     /// \brief Gets the name of the definition.
     /// \returns The name of the definition.
-    std::string name() const;
+    const std::string& name() const;
 
     // PATH
     /// \brief Gets the definition's full path.
     /// \returns The full path of the definition.
-    std::string path() const;
+    const std::string& path() const;
 
     // UPDATE
     /// \brief Updates the definition's type.
@@ -94,6 +102,10 @@ public:
     /// \brief Updates the size of the definition in bytes.
     /// \param size The new size of the definition in bytes.
     void update_size(uint32_t size);
+    /// \brief Updates the definition's serialized size information.
+    /// \param fixed_size Indicates if the serialized size is the same for every message instance.
+    /// \param serialized_size The serialized size of a single instance in bytes.
+    void update_serialized_size(bool fixed_size, uint32_t serialized_size);
     /// \brief Updates the definition's array length.
     /// \param length The new length to set.
     void update_array_length(uint32_t length);
@@ -109,6 +121,10 @@ private:
     primitive_type_t m_primitive_type;
     /// \brief The definition's size in bytes.
     uint32_t m_size;
+    /// \brief Indicates if the definition's serialized size is the same for every message instance.
+    bool m_fixed_size;
+    /// \brief The definition's serialized size in bytes.
+    uint32_t m_serialized_size;
 
     // ARRAY
     /// \brief The definition's array type string.
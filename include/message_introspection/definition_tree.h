@@ -19,6 +19,20 @@ public:
     /// \brief The fields belonging to this message.
     std::vector<definition_tree_t> fields;
 
+    // CONSTRUCTORS
+    /// \brief Creates an empty definition tree.
+    definition_tree_t();
+
+    // INDEX
+    /// \brief Indexes the fields of the tree by name, recursively.
+    /// \details Path queries on an indexed tree look up each path component in a hash table instead of
+    /// searching the fields, and do not allocate memory. Schemas index their definition trees when building them.
+    /// \note Trees whose fields are added or removed afterwards are searched until they are indexed again. Fields that
+    /// are renamed, reordered or replaced afterwards are still found, but only after the index misses, so call
+    /// index_fields() again after changing a tree's fields.
+    void index_fields();
+
+    // PATH
     /// \brief Checks if a path exists in the definition tree.
     /// \param path The relative path in the tree to check existence for.
     /// \returns TRUE if the path exists, otherwise false.
@@ -38,16 +52,48 @@ public:
     /// \param definitions The vector to store ordered definitions in.
     /// \returns TRUE if succeeded, otherwise FALSE when path does not exist.
     bool get_path_definitions(const std::string& path, std::vector<definition_t>& definitions) const;
+    /// \brief Gets the sub tree for a path in the tree.
+    /// \param path The relative path in the tree to get the sub tree for.
+    /// \returns A pointer to the sub tree, or nullptr if the path does not exist.
+    /// \details Unlike get_path_definition(), this does not copy the definition.
+    const definition_tree_t* get_path_tree(const std::string& path) const;
+
+    // PRINT
     /// \brief Prints the definition tree to a string.
     /// \returns The definition tree as a string.
     std::string print() const;
 
 private:
-    /// \brief Splits a path up into it's component pieces.
-    /// \param path The path to tokenize.
-    /// \returns A vector of the path components.
-    /// \note This method removes any array indicators.
-    std::vector<std::string> tokenize_path(const std::string& path) const;
+    // INDEX
+    /// \brief An open addressing hash table of field indices, keyed by the fields' names.
+    /// \details The table's size is a power of two, and empty entries are marked with definition_tree_t::s_empty_entry.
+    std::vector<uint32_t> m_field_index;
+    /// \brief The number of fields that were indexed.
+    size_t m_n_indexed;
+    /// \brief Marks an empty entry in the field index.
+    static const uint32_t s_empty_entry;
+    /// \brief Hashes a field name.
+    /// \param begin The first character of the name.
+    /// \param end The character after the name.
+    /// \returns The name's hash.
+    static uint32_t hash_name(const char* begin, const char* end);
+    /// \brief Finds a field of this tree by name.
+    /// \param begin The first character of the name.
+    /// \param end The character after the name.
+    /// \returns A pointer to the first field with the name, or nullptr if none exists.
+    const definition_tree_t* find_field(const char* begin, const char* end) const;
+
+    // PATH
+    /// \brief Gets the next component of a path.
+    /// \param position The position to search from, which is updated to the end of the component.
+    /// \param end The end of the path.
+    /// \param part_begin The first character of the component's name.
+    /// \param part_end The character after the component's name.
+    /// \returns TRUE if a component was found, otherwise FALSE at the end of the path.
+    /// \note Empty components are skipped, and array indicators are excluded from the component's name.
+    static bool next_part(const char*& position, const char* end, const char*& part_begin, const char*& part_end);
+
+    // PRINT
     /// \brief A recursive method for printing a definition tree to a stringstream.
     /// \param stream The output stream to print to.
     /// \param definition_tree The definition tree to print.
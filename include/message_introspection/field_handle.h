@@ -0,0 +1,69 @@
+/// \file message_introspection/field_handle.h
+/// \brief Defines the message_introspection::field_handle_t class.
+#ifndef MESSAGE_INTROSPECTION___FIELD_HANDLE_H
+#define MESSAGE_INTROSPECTION___FIELD_HANDLE_H
+
+#include "message_introspection/definition.h"
+
+#include <string>
+#include <vector>
+
+namespace message_introspection {
+
+/// \brief A pre-resolved reference to a field in a registered message type.
+/// \details Handles are created with introspector::get_handle() and skip path parsing and
+/// hashing when reading fields. A handle remains valid for all messages with the same MD5
+/// hash, and is stale while the introspector is reading a different message type.
+/// A handle can also be read by other introspectors of the same message type, such as those on other threads,
+/// but only the introspector that resolved it caches the field's position between reads.
+class field_handle_t
+{
+public:
+    // CONSTRUCTORS
+    /// \brief Creates an unresolved field handle.
+    field_handle_t();
+
+    // PROPERTIES
+    /// \brief Indicates if the handle has been resolved to a field.
+    /// \returns TRUE if the handle has been resolved, otherwise FALSE.
+    bool is_resolved() const;
+    /// \brief Gets the path that the handle was resolved from.
+    /// \returns The handle's path.
+    std::string path() const;
+    /// \brief Gets the primitive type of the handle's field.
+    /// \returns The primitive type of the field.
+    definition_t::primitive_type_t primitive_type() const;
+
+private:
+    // The introspector is the only class that resolves and reads handles.
+    friend class introspector;
+
+    /// \brief A single step along a field's route through the definition tree.
+    struct step_t
+    {
+        /// \brief The index of the field within its parent's fields.
+        uint32_t field;
+        /// \brief The array index of the field, if the field is an array.
+        uint32_t index;
+    };
+
+    /// \brief The ordered steps from the top level definition to the field.
+    std::vector<step_t> m_route;
+    /// \brief The ID of the schema that the handle was resolved against.
+    uint64_t m_schema;
+    /// \brief The ID of the introspector that resolved the handle.
+    uint64_t m_owner;
+    /// \brief The handle's slot in the resolving introspector's position cache.
+    uint32_t m_slot;
+    /// \brief The generation of the slot when the handle was resolved.
+    /// \details Slots are reused once their message type is evicted, so older handles no longer use them.
+    uint64_t m_generation;
+    /// \brief The path that the handle was resolved from.
+    std::string m_path;
+    /// \brief The primitive type of the handle's field.
+    definition_t::primitive_type_t m_primitive_type;
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,64 @@
+/// \file message_introspection/field_query.h
+/// \brief Defines the message_introspection::field_query_t class.
+#ifndef MESSAGE_INTROSPECTION___FIELD_QUERY_H
+#define MESSAGE_INTROSPECTION___FIELD_QUERY_H
+
+#include "message_introspection/definition.h"
+
+#include <string>
+#include <vector>
+
+namespace message_introspection {
+
+/// \brief A pre-resolved query for a primitive field in every element of one or more arrays.
+/// \details Queries are created with introspector::get_query() from paths whose array indices may be
+/// wildcards or slices, such as "poses[*].pose.position.x" or "ranges[10:20]". Like a field handle, a query
+/// is resolved once per message type, remains valid for all messages with the same MD5 hash, and is stale
+/// while the introspector is reading a different message type.
+class field_query_t
+{
+public:
+    // CONSTRUCTORS
+    /// \brief Creates an unresolved field query.
+    field_query_t();
+
+    // PROPERTIES
+    /// \brief Indicates if the query has been resolved.
+    /// \returns TRUE if the query has been resolved, otherwise FALSE.
+    bool is_resolved() const;
+    /// \brief Gets the path that the query was resolved from.
+    /// \returns The query's path.
+    std::string path() const;
+    /// \brief Gets the primitive type of the query's fields.
+    /// \returns The primitive type of the fields.
+    definition_t::primitive_type_t primitive_type() const;
+
+private:
+    // The introspector is the only class that resolves and evaluates queries.
+    friend class introspector;
+
+    /// \brief A single step along the query's routes through the definition tree.
+    struct step_t
+    {
+        /// \brief The index of the field within its parent's fields.
+        uint32_t field;
+        /// \brief The first array index to visit, if the field is an array.
+        uint32_t begin;
+        /// \brief The array index after the last one to visit, if the field is an array.
+        /// \details Ranges are clipped to the array's length in each message.
+        uint32_t end;
+    };
+
+    /// \brief The ordered steps from the top level definition to the fields.
+    std::vector<step_t> m_steps;
+    /// \brief The ID of the schema that the query was resolved against.
+    uint64_t m_schema;
+    /// \brief The path that the query was resolved from.
+    std::string m_path;
+    /// \brief The primitive type of the query's fields.
+    definition_t::primitive_type_t m_primitive_type;
+};
+
+}
+
+#endif
\ No newline at end of file
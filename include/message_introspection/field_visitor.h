@@ -0,0 +1,65 @@
+/// \file message_introspection/field_visitor.h
+/// \brief Defines the message_introspection::field_visitor class.
+#ifndef MESSAGE_INTROSPECTION___FIELD_VISITOR_H
+#define MESSAGE_INTROSPECTION___FIELD_VISITOR_H
+
+#include "message_introspection/schema.h"
+
+#include <cstdint>
+
+namespace message_introspection {
+
+/// \brief Receives every field of a message during introspector::visit().
+/// \details The visitor is driven by a single pass over the message's serialized bytes, in serialization order.
+/// Fields are identified by their schema node and by their node ID, which is the index of the field's node in the
+/// schema (see schema_t::node()). Node IDs are stable for a message type, so visitors can precompute per-field
+/// state such as paths or column indices once, and look it up by node ID without hashing or allocating memory.
+///
+/// Data pointers refer directly to the message's serialized bytes, which are little endian and not necessarily aligned.
+class field_visitor
+{
+public:
+    /// \brief Destroys the visitor.
+    virtual ~field_visitor();
+
+    // FIELDS
+    /// \brief Receives a primitive field.
+    /// \param definition The field's node in the schema.
+    /// \param node The field's node ID.
+    /// \param index The field's index if it is an array element, otherwise 0.
+    /// \param data A pointer to the field's serialized value. For strings, this points to the first character.
+    /// \param size The size of the field's serialized value in bytes. For strings, this is the string's length.
+    virtual void on_field(const schema_t::node_t& definition, uint32_t node, uint32_t index, const uint8_t* data, uint32_t size) = 0;
+    /// \brief Receives an array of fixed size primitives all at once.
+    /// \param definition The array's node in the schema.
+    /// \param node The array's node ID.
+    /// \param data A pointer to the first element's serialized value.
+    /// \param count The number of elements in the array.
+    /// \details The default implementation calls on_field() for each element. Visitors can override this to
+    /// consume large arrays, such as image data, in bulk.
+    virtual void on_primitive_array(const schema_t::node_t& definition, uint32_t node, const uint8_t* data, uint32_t count);
+
+    // STRUCTURE
+    /// \brief Marks the start of a message instance, including the top level message.
+    /// \param definition The message's node in the schema.
+    /// \param node The message's node ID.
+    /// \param index The message's index if it is an array element, otherwise 0.
+    virtual void on_message_begin(const schema_t::node_t& definition, uint32_t node, uint32_t index);
+    /// \brief Marks the end of a message instance.
+    /// \param definition The message's node in the schema.
+    /// \param node The message's node ID.
+    virtual void on_message_end(const schema_t::node_t& definition, uint32_t node);
+    /// \brief Marks the start of an array.
+    /// \param definition The array's node in the schema.
+    /// \param node The array's node ID.
+    /// \param count The number of elements in the array.
+    virtual void on_array_begin(const schema_t::node_t& definition, uint32_t node, uint32_t count);
+    /// \brief Marks the end of an array.
+    /// \param definition The array's node in the schema.
+    /// \param node The array's node ID.
+    virtual void on_array_end(const schema_t::node_t& definition, uint32_t node);
+};
+
+}
+
+#endif
\ No newline at end of file
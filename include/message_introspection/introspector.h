@@ -5,25 +5,44 @@
 
 #include "message_introspection/definition.h"
 #include "message_introspection/definition_tree.h"
+#include "message_introspection/field_handle.h"
+#include "message_introspection/field_query.h"
+#include "message_introspection/field_visitor.h"
+#include "message_introspection/schema.h"
+#include "message_introspection/registry.h"
+#include "message_introspection/span.h"
+#include "message_introspection/primitive_traits.h"
 
 #include <topic_tools/shape_shifter.h>
 #include <rosbag/message_instance.h>
 
 #include <string>
 #include <vector>
+#include <list>
+#include <array>
+#include <chrono>
+#include <memory>
 #include <unordered_map>
 #include <sstream>
+#include <type_traits>
 
 /// \brief Code components for message introspection.
 namespace message_introspection {
 
 /// \brief Parses and provides the defintion of a message.
+/// \details Message definitions are parsed once per process into schemas that are shared through the registry.
+/// The introspector itself only holds the state of the message being read, so it is cheap to create.
+/// An introspector must only be used by one thread at a time, so multi-threaded code should create one per thread.
 class introspector
 {
 public:
     // CONSTRUCTORS
     /// \brief Creates a new introspector instance.
     introspector();
+    /// \brief Creates a new introspector instance that reads a registered message type.
+    /// \param schema The shared schema of the message type, from the registry.
+    /// \details Introspectors created from the same schema on different threads share its definition tree and decoder plan.
+    introspector(const std::shared_ptr<const schema_t>& schema);
     ~introspector();
 
     // CONFIG
@@ -32,6 +51,107 @@ public:
     /// \param definition The message's definition string.
     /// \param md5 The message's MD5 hash.
     void new_message_type(const std::string& type, const std::string& definition, const std::string& md5);
+    /// \brief Sets if fields are positioned lazily.
+    /// \param lazy TRUE to index messages when their first field is read, FALSE to index messages when they arrive.
+    /// \details In lazy mode, new_message() only stores the message's serialized bytes, and the message is indexed
+    /// when its first field is read. This avoids indexing messages that are never read. Lazy mode is disabled by default.
+    void set_lazy(bool lazy);
+    /// \brief Indicates if fields are positioned lazily.
+    /// \returns TRUE if lazy mode is enabled, otherwise FALSE.
+    bool is_lazy() const;
+    /// \brief Sets the paths of the fields that are read from each message.
+    /// \param paths The paths of the interesting fields, or nested messages or arrays such as "header". An empty list
+    /// declares every field interesting.
+    /// \details Messages are only indexed up to the end of the last top level field that contains an interesting
+    /// field, so the rest of the message is never walked. This makes reading the header of a message that ends with
+    /// large arrays cost the same as reading a small message. Fields outside the interest set can still be read,
+    /// but are positioned by walking the message from its start. Every field is interesting by default. The current
+    /// message is indexed again for the new interest set when it is next read.
+    void set_interest(const std::vector<std::string>& paths);
+    /// \brief Gets the paths of the fields that are read from each message.
+    /// \returns The paths of the interesting fields, which is empty if every field is interesting.
+    const std::vector<std::string>& interest() const;
+    /// \brief Sets the number of message types that are kept registered.
+    /// \param capacity The maximum number of registered message types, which is at least one.
+    /// \details Each message type's schema is cached by MD5 hash, so switching back to a previously seen type
+    /// does not parse its definition again. Once the cache is full, the least recently used type is evicted.
+    /// The default capacity is 8.
+    void set_schema_capacity(uint32_t capacity);
+    /// \brief Gets the number of message types that are kept registered.
+    /// \returns The maximum number of registered message types.
+    uint32_t schema_capacity() const;
+    /// \brief Sets the largest buffer capacity that is kept between messages.
+    /// \param limit The capacity limit in bytes, or zero for no limit.
+    /// \details The introspector's message buffer and field map only grow, so processing a steady stream of
+    /// messages does not allocate memory. After an unusually large message grows them past the limit, they are
+    /// released when the next message that fits within the limit arrives. There is no limit by default.
+    void set_buffer_limit(uint32_t limit);
+    /// \brief Gets the largest buffer capacity that is kept between messages.
+    /// \returns The capacity limit in bytes, or zero for no limit.
+    uint32_t buffer_limit() const;
+
+    // STATISTICS
+    /// \brief Statistics of the time spent in an operation.
+    /// \details Only a sample of calls is timed (see set_timing_interval()). The total time of all calls can be
+    /// estimated as total_time * n_calls / n_timed.
+    struct timing_t
+    {
+        /// \brief The number of calls to the operation.
+        uint64_t n_calls;
+        /// \brief The number of calls that were timed.
+        uint64_t n_timed;
+        /// \brief The total time of the timed calls.
+        std::chrono::nanoseconds total_time;
+        /// \brief A histogram of the timed calls' durations.
+        /// \details Bucket b counts calls that took from 2^b up to 2^(b+1) nanoseconds. The last bucket also counts longer calls.
+        std::array<uint64_t, 32> histogram;
+    };
+    /// \brief Statistics of the introspector's work since it was created or its statistics were reset.
+    struct stats_t
+    {
+        /// \brief The number of message types that were not in the schema cache, and were taken from the registry.
+        uint64_t n_registrations;
+        /// \brief The number of message types that were switched back to from the schema cache.
+        uint64_t n_schema_cache_hits;
+        /// \brief The number of serialized bytes copied into the introspector's own buffer.
+        uint64_t bytes_copied;
+        /// \brief The number of entries in the current message's field index.
+        /// \details This is a snapshot, so it is not affected by resets.
+        uint64_t n_index_entries;
+        /// \brief The approximate memory used by the field index, position caches and resolved paths, in bytes.
+        /// \details This is a snapshot, so it is not affected by resets. The message buffer is not included.
+        uint64_t index_memory;
+        /// \brief The capacity of the introspector's message buffer in bytes.
+        /// \details This is a snapshot, so it is not affected by resets.
+        uint64_t buffer_capacity;
+        /// \brief The number of messages that kept the previous message's field index, since they had the same shape.
+        uint64_t n_reused_layouts;
+        /// \brief The number of field lookups that found no field.
+        uint64_t n_failed_lookups;
+        /// \brief The time spent registering message types.
+        timing_t registration;
+        /// \brief The time spent in new_message().
+        timing_t messages;
+        /// \brief The time spent looking up fields in the getters, by path and by handle.
+        timing_t lookups;
+        /// \brief The time spent reading batches of handles with get_numbers().
+        /// \details Each handle in a batch is also counted as a call in lookups, but is not timed there.
+        timing_t batches;
+    };
+    /// \brief Gets the introspector's statistics.
+    /// \returns A copy of the current statistics.
+    stats_t stats() const;
+    /// \brief Resets the introspector's counters and timings to zero.
+    void reset_stats();
+    /// \brief Sets how often operations are timed.
+    /// \param interval Every interval-th call of each operation is timed, or zero to disable timing.
+    /// \details Reading the clock costs about as much as reading a field by handle, so only a sample of calls is
+    /// timed. The interval counts the calls of all timed operations together. Counters are always kept.
+    /// The default interval is 64.
+    void set_timing_interval(uint32_t interval);
+    /// \brief Gets how often operations are timed.
+    /// \returns The timing interval, or zero if timing is disabled.
+    uint32_t timing_interval() const;
 
     // NEW MESSAGE
     /// \brief Sets a new topic message instance to read from.
@@ -40,13 +160,85 @@ public:
     /// \brief Sets a new rosbag message instance to read from.
     /// \param message The new message instance.
     void new_message(const rosbag::MessageInstance& message);
+    /// \brief Sets a new serialized message to read from.
+    /// \param data The message's serialized bytes.
+    /// \param length The number of serialized bytes.
+    /// \param md5 The message's MD5 hash.
+    /// \param type The message's ROS type.
+    /// \param definition The message's definition string.
+    /// \param borrow TRUE to read directly from the caller's memory, FALSE to copy it.
+    /// \returns TRUE if the message was set. Returns FALSE if the message is 4 GiB or larger, which ROS cannot serialize.
+    /// The introspector then holds no message, and last_status() is TOO_LARGE.
+    /// \details Borrowing avoids copying large messages, such as images and point clouds. A borrowed buffer
+    /// must remain valid and unchanged until the next new message is set or the introspector is destroyed.
+    bool new_message(const uint8_t* data, size_t length, const std::string& md5, const std::string& type, const std::string& definition, bool borrow = false);
 
     // DEFINITION
-    /// \brief Gets a copy of the message's definition tree.
-    /// \returns The message's current definition tree.
-    definition_tree_t definition_tree() const;
+    /// \brief Gets the shared schema of the current message type.
+    /// \returns The current schema, or nullptr if no message type is registered.
+    std::shared_ptr<const schema_t> schema() const;
+    /// \brief Gets the message's definition tree.
+    /// \returns A reference to the current definition tree, or to an empty tree if no message type is registered.
+    /// \details The tree is not copied. The reference is valid until the introspector registers another message
+    /// type, or is destroyed. Use shared_definition_tree() to keep the tree beyond that.
+    const definition_tree_t& definition_tree() const;
+    /// \brief Gets a shared snapshot of the message's definition tree.
+    /// \returns A pointer to the current definition tree, or nullptr if no message type is registered.
+    /// \details The tree is not copied. The pointer shares ownership of the tree's schema, so the tree stays
+    /// valid and unchanged after the introspector moves on to other message types.
+    std::shared_ptr<const definition_tree_t> shared_definition_tree() const;
+
+    // HANDLES
+    /// \brief Resolves a field path into a handle for repeated reads.
+    /// \param path The path of the primitive field to resolve, including any array indices.
+    /// \param handle The handle to store the resolved field in.
+    /// \returns TRUE if the path exists in the registered message type, otherwise FALSE.
+    /// \details Handles are resolved once per message type and skip path parsing and hashing
+    /// when reading fields. The field's position in each new message is computed on the first read
+    /// and cached until the next message arrives. Resolving the same field again shares its position
+    /// cache slot, and the slots of a message type are released when the type is evicted from the schema cache.
+    /// \note A message type must be registered before handles can be resolved.
+    bool get_handle(const std::string& path, field_handle_t& handle);
+    /// \brief Indicates if a handle was resolved against a different message type than the current one.
+    /// \details A handle becomes current again when the introspector switches back to its message type.
+    /// \param handle The handle to check.
+    /// \returns TRUE if the handle is stale and must be resolved again, otherwise FALSE.
+    bool is_stale(const field_handle_t& handle) const;
+    /// \brief Resolves a query path into a query for repeated reads.
+    /// \param path The path of the primitive fields to query. Each array index may be a single index such as [3],
+    /// a wildcard [*] for every element, or a slice [a:b] for the elements from a up to but excluding b.
+    /// Either end of a slice may be omitted, as in [a:] or [:b].
+    /// \param query The query to store the resolved path in.
+    /// \returns TRUE if the path exists in the registered message type, otherwise FALSE.
+    /// \details Queries are resolved once per message type. Each message is then read with get_numbers() without
+    /// building a path for each element.
+    /// \note A message type must be registered before queries can be resolved.
+    bool get_query(const std::string& path, field_query_t& query) const;
+    /// \brief Indicates if a query was resolved against a different message type than the current one.
+    /// \param query The query to check.
+    /// \returns TRUE if the query is stale and must be resolved again, otherwise FALSE.
+    bool is_stale(const field_query_t& query) const;
 
     // GET
+    /// \brief The outcome of a field lookup.
+    enum class status_t
+    {
+        OK = 0,
+        NO_MESSAGE = 1,
+        STALE_HANDLE = 2,
+        NOT_FOUND = 3,
+        OUT_OF_BOUNDS = 4,
+        TYPE_MISMATCH = 5,
+        TOO_LARGE = 6
+    };
+    /// \brief Gets the outcome of the most recent lookup.
+    /// \returns The status of the last getter or get_handle() call.
+    /// \details Getters never throw, and only return FALSE on failure. This tells why the last one failed:
+    /// NO_MESSAGE if there was no message, STALE_HANDLE if the handle belongs to another message type,
+    /// NOT_FOUND if the path does not exist, OUT_OF_BOUNDS if an array index is beyond the array's length,
+    /// and TYPE_MISMATCH if the field exists but is not of the requested type.
+    /// After new_message() rejects a message, it is TOO_LARGE until the next lookup.
+    status_t last_status() const;
     /// \brief Indicates if the path to a field exists.
     /// \param path The path to verify.
     /// \returns TRUE if the path exists, otherwise false.
@@ -123,6 +315,13 @@ public:
     /// \returns TRUE if the value was retrieved.
     /// Returns FALSE if the path does not exist or the field type doesn't match.
     bool get_string(const std::string& path, std::string& value) const;
+    /// \brief Gets a view of a string field in the message.
+    /// \param path The path to get the field from.
+    /// \param value The span to store the view of the string's characters in.
+    /// \returns TRUE if the value was retrieved.
+    /// Returns FALSE if the path does not exist or the field type doesn't match.
+    /// \details The span reads directly from the message's serialized bytes without copying them, and is valid until the next message arrives.
+    bool get_string(const std::string& path, span_t<char>& value) const;
     /// \brief Gets a time field from the message.
     /// \param path The path to get the field from.
     /// \param value The reference to store the retrieved value in.
@@ -144,6 +343,218 @@ public:
     /// Time/Duration fields return seconds as a double.
     /// String fields are attempted to be parsed into a number (may return NaN if string is not a number).
     bool get_number(const std::string& path, double& value) const;
+    /// \brief Gets a view of a primitive array in the message.
+    /// \tparam T The element type of the array, such as float or uint8_t.
+    /// \param path The path of the array, without an index (e.g. "ranges").
+    /// \param values The span to store the view of the array in.
+    /// \returns TRUE if the array was retrieved.
+    /// Returns FALSE if the path is not an array of fixed size primitives, or the element type doesn't match.
+    /// \details The span reads directly from the message's serialized bytes without copying them, and is valid until the next message arrives.
+    /// This is the fastest way to read large arrays such as sensor_msgs/LaserScan ranges or sensor_msgs/Image data.
+    template<typename T>
+    bool get_array(const std::string& path, span_t<T>& values) const
+    {
+        // Find the array and check its element type.
+        field_t field;
+        uint32_t count;
+        if(!introspector::find_array(path, field, count))
+        {
+            return false;
+        }
+        if(field.primitive_type != primitive_traits_t<T>::type())
+        {
+            introspector::m_status = status_t::TYPE_MISMATCH;
+            return false;
+        }
+
+        values = span_t<T>(&(introspector::m_bytes[field.position]), count);
+        return true;
+    }
+    /// \brief Gets a copy of a primitive array in the message.
+    /// \tparam T The element type of the array, such as float or uint8_t.
+    /// \param path The path of the array, without an index (e.g. "ranges").
+    /// \param values The vector to copy the array's elements into, which is resized to the number of elements.
+    /// \returns TRUE if the array was retrieved.
+    /// Returns FALSE if the path is not an array of fixed size primitives, or the element type doesn't match.
+    /// \details The elements are copied with a single memcpy.
+    template<typename T>
+    bool get_array(const std::string& path, std::vector<T>& values) const
+    {
+        static_assert(!std::is_same<T, bool>::value, "std::vector<bool> is not contiguous. Read bool arrays with a span_t<bool>.");
+
+        // Get a view of the array and copy it.
+        span_t<T> span;
+        if(!introspector::get_array(path, span))
+        {
+            return false;
+        }
+
+        values.resize(span.size());
+        span.copy(values.data());
+        return true;
+    }
+    /// \brief Indicates if a handle's field exists in the current message.
+    /// \param handle The handle to verify.
+    /// \returns TRUE if the field exists, otherwise false.
+    bool path_exists(const field_handle_t& handle) const;
+    /// \brief Gets a bool field from the message.
+    /// \param handle The handle of the field to get.
+    /// \param value The reference to store the retrieved value in.
+    /// \returns TRUE if the value was retrieved.
+    /// Returns FALSE if the handle is stale, the field does not exist, or the field type doesn't match.
+    bool get_bool(const field_handle_t& handle, bool& value) const;
+    /// \brief Gets an int8 field from the message.
+    /// \param handle The handle of the field to get.
+    /// \param value The reference to store the retrieved value in.
+    /// \returns TRUE if the value was retrieved.
+    /// Returns FALSE if the handle is stale, the field does not exist, or the field type doesn't match.
+    bool get_int8(const field_handle_t& handle, int8_t& value) const;
+    /// \brief Gets an int16 field from the message.
+    /// \param handle The handle of the field to get.
+    /// \param value The reference to store the retrieved value in.
+    /// \returns TRUE if the value was retrieved.
+    /// Returns FALSE if the handle is stale, the field does not exist, or the field type doesn't match.
+    bool get_int16(const field_handle_t& handle, int16_t& value) const;
+    /// \brief Gets an int32 field from the message.
+    /// \param handle The handle of the field to get.
+    /// \param value The reference to store the retrieved value in.
+    /// \returns TRUE if the value was retrieved.
+    /// Returns FALSE if the handle is stale, the field does not exist, or the field type doesn't match.
+    bool get_int32(const field_handle_t& handle, int32_t& value) const;
+    /// \brief Gets an int64 field from the message.
+    /// \param handle The handle of the field to get.
+    /// \param value The reference to store the retrieved value in.
+    /// \returns TRUE if the value was retrieved.
+    /// Returns FALSE if the handle is stale, the field does not exist, or the field type doesn't match.
+    bool get_int64(const field_handle_t& handle, int64_t& value) const;
+    /// \brief Gets a uint8 field from the message.
+    /// \param handle The handle of the field to get.
+    /// \param value The reference to store the retrieved value in.
+    /// \returns TRUE if the value was retrieved.
+    /// Returns FALSE if the handle is stale, the field does not exist, or the field type doesn't match.
+    bool get_uint8(const field_handle_t& handle, uint8_t& value) const;
+    /// \brief Gets a uint16 field from the message.
+    /// \param handle The handle of the field to get.
+    /// \param value The reference to store the retrieved value in.
+    /// \returns TRUE if the value was retrieved.
+    /// Returns FALSE if the handle is stale, the field does not exist, or the field type doesn't match.
+    bool get_uint16(const field_handle_t& handle, uint16_t& value) const;
+    /// \brief Gets a uint32 field from the message.
+    /// \param handle The handle of the field to get.
+    /// \param value The reference to store the retrieved value in.
+    /// \returns TRUE if the value was retrieved.
+    /// Returns FALSE if the handle is stale, the field does not exist, or the field type doesn't match.
+    bool get_uint32(const field_handle_t& handle, uint32_t& value) const;
+    /// \brief Gets a uint64 field from the message.
+    /// \param handle The handle of the field to get.
+    /// \param value The reference to store the retrieved value in.
+    /// \returns TRUE if the value was retrieved.
+    /// Returns FALSE if the handle is stale, the field does not exist, or the field type doesn't match.
+    bool get_uint64(const field_handle_t& handle, uint64_t& value) const;
+    /// \brief Gets a float32 field from the message.
+    /// \param handle The handle of the field to get.
+    /// \param value The reference to store the retrieved value in.
+    /// \returns TRUE if the value was retrieved.
+    /// Returns FALSE if the handle is stale, the field does not exist, or the field type doesn't match.
+    bool get_float32(const field_handle_t& handle, float& value) const;
+    /// \brief Gets a float64 field from the message.
+    /// \param handle The handle of the field to get.
+    /// \param value The reference to store the retrieved value in.
+    /// \returns TRUE if the value was retrieved.
+    /// Returns FALSE if the handle is stale, the field does not exist, or the field type doesn't match.
+    bool get_float64(const field_handle_t& handle, double& value) const;
+    /// \brief Gets a string field from the message.
+    /// \param handle The handle of the field to get.
+    /// \param value The reference to store the retrieved value in.
+    /// \returns TRUE if the value was retrieved.
+    /// Returns FALSE if the handle is stale, the field does not exist, or the field type doesn't match.
+    bool get_string(const field_handle_t& handle, std::string& value) const;
+    /// \brief Gets a view of a string field in the message.
+    /// \param handle The handle of the field to get.
+    /// \param value The span to store the view of the string's characters in.
+    /// \returns TRUE if the value was retrieved.
+    /// Returns FALSE if the handle is stale, the field does not exist, or the field type doesn't match.
+    /// \details The span reads directly from the message's serialized bytes without copying them, and is valid until the next message arrives.
+    bool get_string(const field_handle_t& handle, span_t<char>& value) const;
+    /// \brief Gets a time field from the message.
+    /// \param handle The handle of the field to get.
+    /// \param value The reference to store the retrieved value in.
+    /// \returns TRUE if the value was retrieved.
+    /// Returns FALSE if the handle is stale, the field does not exist, or the field type doesn't match.
+    bool get_time(const field_handle_t& handle, ros::Time& value) const;
+    /// \brief Gets a duration field from the message.
+    /// \param handle The handle of the field to get.
+    /// \param value The reference to store the retrieved value in.
+    /// \returns TRUE if the value was retrieved.
+    /// Returns FALSE if the handle is stale, the field does not exist, or the field type doesn't match.
+    bool get_duration(const field_handle_t& handle, ros::Duration& value) const;
+    /// \brief Gets any primitive field from the message as a number.
+    /// \param handle The handle of the field to get.
+    /// \param value The reference to store the retrieved value in.
+    /// \returns TRUE if the value was retrieved.
+    /// Returns FALSE if the handle is stale or the field does not exist.
+    /// \details See get_number(const std::string&, double&) for conversion details.
+    bool get_number(const field_handle_t& handle, double& value) const;
+    /// \brief Gets a field from the message.
+    /// \tparam T The type of the field: a fixed size primitive such as uint32_t or double, std::string, ros::Time or ros::Duration.
+    /// \param path The path to get the field from.
+    /// \param value The reference to store the retrieved value in.
+    /// \returns TRUE if the value was retrieved.
+    /// Returns FALSE if the path does not exist or the field type doesn't match T.
+    /// \details The primitive type that T reads is chosen at compile time, so get<uint32_t>() is the same as get_uint32().
+    template<typename T>
+    bool get(const std::string& path, T& value) const
+    {
+        field_t field;
+        return introspector::find_field(path, field) && introspector::read_typed(field, value);
+    }
+    /// \brief Gets a field from the message.
+    /// \tparam T The type of the field: a fixed size primitive such as uint32_t or double, std::string, ros::Time or ros::Duration.
+    /// \param handle The handle of the field to get.
+    /// \param value The reference to store the retrieved value in.
+    /// \returns TRUE if the value was retrieved.
+    /// Returns FALSE if the handle is stale, the field does not exist, or the field type doesn't match T.
+    template<typename T>
+    bool get(const field_handle_t& handle, T& value) const
+    {
+        field_t field;
+        return introspector::find_field(handle, field) && introspector::read_typed(field, value);
+    }
+    /// \brief Gets many primitive fields from the message as numbers.
+    /// \param paths The paths to get the fields from.
+    /// \param values The array to store the retrieved values in, which must hold one value per path.
+    /// \param valid An optional array to store 1 in for each field that was retrieved and 0 otherwise.
+    /// \returns The number of fields that were retrieved.
+    /// \details Fields are converted as in get_number(const std::string&, double&). Fields that could not be retrieved
+    /// are stored as NaN, and last_status() reports why the last of them failed.
+    uint32_t get_numbers(const std::vector<std::string>& paths, double* values, uint8_t* valid = nullptr) const;
+    /// \brief Gets many primitive fields from the message as numbers.
+    /// \param handles The handles of the fields to get.
+    /// \param values The array to store the retrieved values in, which must hold one value per handle.
+    /// \param valid An optional array to store 1 in for each field that was retrieved and 0 otherwise.
+    /// \returns The number of fields that were retrieved.
+    /// \details This is the fastest way to convert many fields of each message, such as when bridging telemetry.
+    /// The message and handles are checked once for the whole batch, and handles that were already positioned in
+    /// the current message are read directly from the position cache.
+    uint32_t get_numbers(const std::vector<field_handle_t>& handles, double* values, uint8_t* valid = nullptr) const;
+    /// \brief Gets every primitive field that matches a query as numbers.
+    /// \param query The query of the fields to get.
+    /// \param values The vector to store the retrieved values in, in the order that they are serialized.
+    /// \returns TRUE if the query was evaluated over the whole message.
+    /// Returns FALSE if the query is stale, or if the message ends early, in which case the fields before the end were retrieved.
+    /// \details Fields are converted as in get_number(const std::string&, double&). Slices are clipped to the length of
+    /// each array, so arrays that are shorter than a slice contribute fewer values. The values vector is cleared first
+    /// and keeps its storage, so reading a query from each message does not allocate memory once the vector has grown.
+    bool get_numbers(const field_query_t& query, std::vector<double>& values) const;
+
+    // VISIT
+    /// \brief Passes every field of the message to a visitor in a single pass.
+    /// \param visitor The visitor to pass the fields to.
+    /// \returns TRUE if the whole message was visited.
+    /// Returns FALSE if there is no message, or if the message ends early, in which case the fields before the end were visited.
+    /// \details The message is read directly in serialization order without using the field index, so this is the
+    /// fastest way to consume every field of a message, such as when exporting whole messages.
+    bool visit(field_visitor& visitor) const;
 
     // PRINTING
     /// \brief Prints the message's component definitions to a string.
@@ -159,33 +570,66 @@ private:
     /// \param md5 The message's MD5 hash.
     /// \param type The message's data type string.
     /// \param definition The message's definition string.
-    /// \details This method will update the component listing and definition tree for the message type.
+    /// \details This method switches to the message type's cached schema, or gets the schema from the registry if the type is not cached.
     void register_message(const std::string& md5, const std::string& type, const std::string& definition);
+    /// \brief Stores the introspector's unique ID.
+    uint64_t m_id;
     /// \brief Indicates if a message MD5 hash is registered or not.
     /// \param md5 The MD5 hash to check.
     /// \returns TRUE if the MD5 hash is registered, otherwise FALSE.
     bool is_registered(const std::string& md5);
-    /// \brief Stores the currently registered message MD5 hash.
-    std::string m_md5;
-    /// \brief Stores the serialized bytes of the most recent message instance.
-    uint8_t* m_bytes;
-
-    // COMPONENTS
-    /// \brief A map of component message definitions (top level only)
-    std::unordered_map<std::string, std::vector<definition_t>> m_component_definitions;
-    /// \brief Parses a message definition string into the component definition map.
-    /// \param message_type The ROS message type string.
-    /// \param introspector The ROS message definition string.
-    void parse_components(std::string message_type, std::string introspector);
+    /// \brief Stores the introspector's own copy of the most recent message instance's serialized bytes.
+    /// \details The buffer is reused between messages, and only reallocated when a larger message arrives.
+    uint8_t* m_buffer;
+    /// \brief Stores the capacity of the buffer in bytes.
+    uint32_t m_capacity;
+    /// \brief Stores the largest buffer capacity that is kept between messages, or zero for no limit.
+    uint32_t m_buffer_limit;
+    /// \brief Points to the serialized bytes of the most recent message instance.
+    const uint8_t* m_bytes;
+    /// \brief Stores the length of the most recent message instance's serialized bytes.
+    uint32_t m_length;
+    /// \brief Stores a counter that is incremented for each new message instance.
+    uint64_t m_message;
+    /// \brief Allocates the introspector's own storage for a new message instance.
+    /// \param length The number of serialized bytes to store.
+    /// \returns A pointer to the storage, which the message's serialized bytes must be written to.
+    uint8_t* allocate_bytes(uint32_t length);
+    /// \brief Reads a new message instance directly from the caller's memory.
+    /// \param data The message's serialized bytes.
+    /// \param length The number of serialized bytes.
+    void borrow_bytes(const uint8_t* data, uint32_t length);
+    /// \brief Releases the buffer and field index after an outlier message.
+    void release_bytes();
+    /// \brief Parses the most recently stored message instance.
+    void parse_message();
 
-    // DEFINITION
-    /// \brief The message's calculated definition tree.
-    definition_tree_t m_definition_tree;    
-    /// \brief A recursive method for adding new definitions to the definition tree.
-    /// \param parent_path The parent path of the definition tree being added.
-    /// \param definition_tree A reference to the definition tree to add to.
-    /// \param component_definition The component information to add to the definition's sub tree.
-    void add_definition(const std::string& parent_path, definition_tree_t& definition_tree, const definition_t& component_definition);
+    // STATISTICS
+    /// \brief Stores the introspector's statistics.
+    /// \details Snapshot fields are only filled in by stats().
+    mutable stats_t m_stats;
+    /// \brief Stores how often operations are timed, or zero if timing is disabled.
+    uint32_t m_timing_interval;
+    /// \brief Counts down the calls until the next timed call.
+    /// \details One countdown is shared by all operations, which avoids a division on every call.
+    mutable uint32_t m_timing_countdown;
+    /// \brief Counts a call of an operation, and starts timing it if it is sampled.
+    /// \param timing The operation's timing statistics.
+    /// \returns The call's start time, or a default time point if the call is not timed.
+    std::chrono::steady_clock::time_point start_timing(timing_t& timing) const;
+    /// \brief Finishes timing a call of an operation.
+    /// \param timing The operation's timing statistics.
+    /// \param start The call's start time from start_timing().
+    void stop_timing(timing_t& timing, std::chrono::steady_clock::time_point start) const;
+    /// \brief Finishes a field lookup.
+    /// \param start The lookup's start time from start_timing().
+    /// \param status The lookup's outcome.
+    /// \returns TRUE if the lookup found a field, otherwise FALSE.
+    bool end_lookup(std::chrono::steady_clock::time_point start, status_t status) const;
+
+    // STATUS
+    /// \brief Stores the outcome of the most recent lookup.
+    mutable status_t m_status;
 
     // LISTING
     /// \brief A method for getting the definition tree of a specified path.
@@ -193,7 +637,7 @@ private:
     /// \returns If the path exists, a pointer to the definition tree, otherwise nullptr.
     const definition_tree_t* get_definition_tree(const std::string& path) const;
 
-    // FIELD MAPPING
+    // FIELD INDEX
     /// \brief Store the position and type of a read field.
     struct field_t
     {
@@ -202,14 +646,272 @@ private:
         /// \brief Stores the primitive type of the field.
         definition_t::primitive_type_t primitive_type;
     };
-    /// \brief Stores a map of fields in a parsed serialized message.
-    /// \details Field details are mapped to their fully qualified path string.
-    std::unordered_map<std::string, field_t> m_field_map;
-    /// \brief Updates the field map by recursively parsing a message's serialized bytes.
-    /// \param definition_tree The definition tree to recurse on.
-    /// \param current_path The current fully qualified path of recursion.
-    /// \param current_position The current position in the message's serialized bytes.
-    void update_field_map(const definition_tree_t& definition_tree, const std::string& current_path, uint32_t& current_position);
+    /// \brief Indicates if the message is indexed lazily.
+    bool m_lazy;
+    /// \brief Stores the position of a string or array in the current message.
+    struct anchor_t
+    {
+        /// \brief The position of the string's length, or of the array's first element.
+        uint32_t position;
+        /// \brief The position after the end of the string or array.
+        uint32_t end;
+        /// \brief The number of elements in the array.
+        uint32_t count;
+        /// \brief The index of the first element's frame, if the array's elements have variable sizes.
+        uint32_t first_frame;
+    };
+    /// \brief Stores an instance of a scope in the current message.
+    struct frame_t
+    {
+        /// \brief The position of the start of the scope.
+        uint32_t position;
+        /// \brief The index of the scope's first anchor.
+        uint32_t first_anchor;
+    };
+    /// \brief Stores the anchors of the current message.
+    /// \details Each frame's anchors are stored contiguously, in the order of the schema's anchor slots.
+    mutable std::vector<anchor_t> m_anchors;
+    /// \brief Stores the frames of the current message, starting with the top level message.
+    /// \details The frames of an array's elements are stored contiguously.
+    mutable std::vector<frame_t> m_frames;
+    /// \brief Stores the message counter value that the index was built for.
+    mutable uint64_t m_indexed;
+    /// \brief Stores the number of top level fields that the index covers.
+    /// \details Messages that end early are not indexed, and fields that the index does not cover are located by walking their routes instead.
+    mutable uint32_t m_indexed_fields;
+    /// \brief Stores a length that was read while indexing the message.
+    struct shape_entry_t
+    {
+        /// \brief The position of the length in the message.
+        uint32_t position;
+        /// \brief The string length or array count.
+        uint32_t length;
+    };
+    /// \brief Stores the shape of the indexed message, which is every string length and array count that was read while indexing it.
+    mutable std::vector<shape_entry_t> m_shape;
+    /// \brief Stores the ID of the schema that the shape belongs to, or zero if there is no shape to match.
+    mutable uint64_t m_shape_schema;
+    /// \brief Stores the length of the message that the shape was read from.
+    mutable uint32_t m_shape_length;
+    /// \brief Counts the distinct layouts that the index has held.
+    /// \details The layout only changes when a message's shape differs from the previous message's, so positions
+    /// cached for a layout stay valid for the following messages with the same shape.
+    mutable uint64_t m_layout;
+    /// \brief Indicates if the current message has the same shape as the indexed message.
+    /// \returns TRUE if the index can be kept for the current message, otherwise FALSE.
+    /// \details Each recorded length is compared at its position. Since every position only depends on the lengths
+    /// before it, matching lengths imply matching positions throughout the indexed part of the message.
+    bool match_shape() const;
+    /// \brief Indexes the current message by running its schema's decoder plan over the serialized bytes.
+    /// \details The index only stores the strings and arrays of the message, and the elements of arrays whose
+    /// elements have variable sizes. Its size depends on the schema rather than on the length of the message.
+    void index_message() const;
+    /// \brief Positions a field or whole array in the current message.
+    /// \param route The route to the field or array.
+    /// \param array TRUE if the route ends with a whole array, otherwise FALSE.
+    /// \param field The field instance to store the field or the array's first element in.
+    /// \param count The number of elements, if the route ends with a whole array.
+    /// \returns TRUE if the field exists, otherwise FALSE.
+    /// \details The message is indexed first if it hasn't been indexed yet.
+    bool position_field(const std::vector<field_handle_t::step_t>& route, bool array, field_t& field, uint32_t& count) const;
+    /// \brief Computes the position of a field or whole array from the index.
+    /// \param route The route to the field or array.
+    /// \param array TRUE if the route ends with a whole array, otherwise FALSE.
+    /// \param field The field instance to store the field or the array's first element in.
+    /// \param count The number of elements, if the route ends with a whole array.
+    /// \returns TRUE if the field exists, otherwise FALSE.
+    bool compute_position(const std::vector<field_handle_t::step_t>& route, bool array, field_t& field, uint32_t& count) const;
+
+    // PLAN
+    /// \brief An array that is being looped through while running the decoder plan.
+    struct loop_t
+    {
+        /// \brief The index of the array's ARRAY operation.
+        uint32_t instruction;
+        /// \brief The number of elements in the array.
+        uint32_t count;
+        /// \brief The index of the current element.
+        uint32_t index;
+        /// \brief The index of the array's anchor.
+        uint32_t anchor;
+        /// \brief The index of the frame that contains the array.
+        uint32_t frame;
+    };
+    /// \brief Stores the loops of the decoder plan while it is running.
+    mutable std::vector<loop_t> m_plan_loops;
+
+    // PATHS
+    /// \brief Stores the pattern of the path being resolved.
+    mutable std::string m_pattern;
+    /// \brief Stores the array indices of the path being resolved.
+    mutable std::vector<uint32_t> m_indices;
+    /// \brief Stores the route of the path being resolved.
+    mutable std::vector<field_handle_t::step_t> m_route;
+    /// \brief Resolves a path into a route through the current schema.
+    /// \param path The path to resolve.
+    /// \returns The path's pattern if it is valid, otherwise nullptr. The path's route is stored in m_route.
+    /// \details Array indices are removed from the path to get its pattern, so the elements of an array share a single
+    /// pattern. Each pattern is resolved against the schema once, and the indices are then applied to it.
+    const schema_t::pattern_t* resolve_path(const std::string& path) const;
+    /// \brief Finds a field in the current message.
+    /// \param path The path of the field to find.
+    /// \param field The field instance to store the result in.
+    /// \returns TRUE if the field exists, otherwise FALSE.
+    bool find_field(const std::string& path, field_t& field) const;
+    /// \brief Finds a whole array of fixed size primitives in the current message.
+    /// \param path The path of the array to find, without an index.
+    /// \param field The field instance to store the array's first element in.
+    /// \param count The number of elements in the array.
+    /// \returns TRUE if the array exists, otherwise FALSE.
+    bool find_array(const std::string& path, field_t& field, uint32_t& count) const;
+    /// \brief Gets the resolved pattern of the current schema.
+    /// \param pattern The pattern to get, with empty brackets on each indexed array.
+    /// \returns The resolved pattern, which is resolved against the schema the first time it is seen.
+    const schema_t::pattern_t& find_pattern(const std::string& pattern) const;
+
+    // QUERIES
+    /// \brief Collects the fields of a query's remaining steps from the field index.
+    /// \param steps The query's steps.
+    /// \param s The index of the next step.
+    /// \param node The ID of the node reached by the previous step.
+    /// \param frame The index of the frame that contains the current instance.
+    /// \param position The position of the node reached by the previous step.
+    /// \param fixed Indicates if the current instance has a fixed size, so its fields are found by their offset.
+    /// \param values The vector to add the fields' values to.
+    void collect_query(const std::vector<field_query_t::step_t>& steps, size_t s, uint32_t node, uint32_t frame, uint32_t position, bool fixed, std::vector<double>& values) const;
+    /// \brief Collects the fields of a query's remaining steps by walking through the message's serialized bytes.
+    /// \param steps The query's steps.
+    /// \param s The index of the next step.
+    /// \param node The ID of the current instance's node.
+    /// \param position The position of the current instance.
+    /// \param values The vector to add the fields' values to.
+    /// \returns TRUE if the fields were collected within the message's bounds, otherwise FALSE.
+    bool walk_query(const std::vector<field_query_t::step_t>& steps, size_t s, uint32_t node, uint32_t position, std::vector<double>& values) const;
+
+    // SCHEMA CACHE
+    /// \brief Stores a cached schema and the patterns that have been resolved against it.
+    struct schema_entry_t
+    {
+        /// \brief The shared schema of the message type.
+        std::shared_ptr<const schema_t> schema;
+        /// \brief Stores the resolved patterns of paths that have been read, keyed by pattern.
+        /// \details Elements of an array share a pattern, so the map's size depends on the schema rather than on the messages.
+        std::unordered_map<std::string, schema_t::pattern_t> patterns;
+        /// \brief The number of top level fields that contain the interest set's fields.
+        uint32_t interest_fields;
+        /// \brief Stores the position cache slots of the handles resolved against the schema, keyed by route.
+        std::unordered_map<std::string, uint32_t> slots;
+    };
+    /// \brief Stores the cached schemas, ordered from most to least recently used.
+    std::list<schema_entry_t> m_schemas;
+    /// \brief Maps MD5 hashes to their cached schemas.
+    std::unordered_map<std::string, std::list<schema_entry_t>::iterator> m_schema_index;
+    /// \brief Stores the maximum number of cached schemas.
+    uint32_t m_schema_capacity;
+    /// \brief Points to the cache entry of the currently registered message type, or nullptr if no type is registered.
+    /// \details The entry's patterns are updated in place by const getters.
+    schema_entry_t* m_schema;
+    /// \brief Adds a schema to the front of the cache and switches to it.
+    /// \param schema The schema to add.
+    void add_schema(const std::shared_ptr<const schema_t>& schema);
+    /// \brief Evicts the least recently used schemas until the cache is within its capacity.
+    void trim_schemas();
+
+    // INTEREST
+    /// \brief Stores the paths of the interesting fields.
+    std::vector<std::string> m_interest;
+    /// \brief Finds the number of top level fields that contain the interest set's fields in a cached schema.
+    /// \param entry The schema's cache entry, whose interest_fields is updated.
+    void update_interest(schema_entry_t& entry) const;
+
+    // HANDLE POSITIONING
+    /// \brief Stores the cached field of a handle.
+    struct handle_cache_t
+    {
+        /// \brief The layout that the cached field was located in.
+        uint64_t layout;
+        /// \brief Indicates if the field exists in the message.
+        bool exists;
+        /// \brief The located field.
+        field_t field;
+        /// \brief Counts the times the slot was released, so handles from before a release no longer use it.
+        uint64_t generation;
+    };
+    /// \brief Stores the cached fields of resolved handles, indexed by handle slot.
+    mutable std::vector<handle_cache_t> m_handle_cache;
+    /// \brief Stores the slots of the position cache that were released by evicted schemas.
+    std::vector<uint32_t> m_free_slots;
+    /// \brief Stores the route of the last resolved handle as a key for the slots map.
+    std::string m_route_key;
+    /// \brief Indicates if a handle has a slot in this introspector's position cache.
+    /// \param handle The handle to check.
+    /// \returns TRUE if the handle was resolved by this introspector and its slot has not been released, otherwise FALSE.
+    bool has_slot(const field_handle_t& handle) const;
+    /// \brief Finds a handle's field in the current message.
+    /// \param handle The handle of the field to find.
+    /// \param field The field instance to store the result in.
+    /// \returns TRUE if the handle is current and the field exists, otherwise FALSE.
+    /// \details The field is positioned on the first call for each layout and cached thereafter, so consecutive
+    /// messages with the same shape do not position it again.
+    /// Handles resolved by another introspector with the same schema are positioned on every call.
+    bool find_field(const field_handle_t& handle, field_t& field) const;
+
+    // ROUTE WALKING
+    /// \brief Locates a field by following its route through the message's serialized bytes.
+    /// \param route The route to follow.
+    /// \param field The field instance to store the result in.
+    /// \returns TRUE if the field exists in the message, otherwise FALSE.
+    bool locate_field(const std::vector<field_handle_t::step_t>& route, field_t& field) const;
+    /// \brief Locates a whole array by following its route through the message's serialized bytes.
+    /// \param route The route to follow, whose last step is the array.
+    /// \param field The field instance to store the array's first element in.
+    /// \param count The number of elements in the array.
+    /// \returns TRUE if all of the array's elements lie within the message, otherwise FALSE.
+    bool locate_array(const std::vector<field_handle_t::step_t>& route, field_t& field, uint32_t& count) const;
+    /// \brief Follows the first steps of a route through the message's serialized bytes.
+    /// \param route The route to follow.
+    /// \param n_steps The number of steps to follow.
+    /// \param current_node The ID of the node reached by the last step followed.
+    /// \param current_position The position reached by the last step followed.
+    /// \returns TRUE if the steps were followed within the message's bounds, otherwise FALSE.
+    bool follow_route(const std::vector<field_handle_t::step_t>& route, size_t n_steps, uint32_t& current_node, uint32_t& current_position) const;
+    /// \brief Moves from an instance to one of its fields.
+    /// \param step The step whose field is moved to.
+    /// \param current_node The ID of the instance's node, which is updated to the field's.
+    /// \param current_position The position of the instance, which is updated to the field's.
+    /// \returns TRUE if the preceding fields were skipped within the message's bounds, otherwise FALSE.
+    bool enter_field(const field_handle_t::step_t& step, uint32_t& current_node, uint32_t& current_position) const;
+    /// \brief Gets the number of elements in an array.
+    /// \param node The ID of the array's node.
+    /// \param position The position of the array, which is moved past a serialized length.
+    /// \param length The number of elements in the array.
+    /// \returns TRUE if the length was read within the message's bounds, otherwise FALSE.
+    bool read_length(uint32_t node, uint32_t& position, uint32_t& length) const;
+    /// \brief Skips over all instances of a definition in the message's serialized bytes.
+    /// \param node The ID of the node to skip over.
+    /// \param position The position of the definition, which is updated to the position after it.
+    /// \returns TRUE if the definition was skipped within the message's bounds, otherwise FALSE.
+    bool skip_definition(uint32_t node, uint32_t& position) const;
+    /// \brief Skips over a single instance of a definition in the message's serialized bytes.
+    /// \param node The ID of the node to skip over.
+    /// \param position The position of the instance, which is updated to the position after it.
+    /// \returns TRUE if the instance was skipped within the message's bounds, otherwise FALSE.
+    bool skip_instance(uint32_t node, uint32_t& position) const;
+
+    // VISITING
+    /// \brief Visits all instances of a node, recursively.
+    /// \param node The ID of the node to visit.
+    /// \param visitor The visitor to pass the fields to.
+    /// \param position The position of the node, which is updated to the position after it.
+    /// \returns TRUE if the node was visited within the message's bounds, otherwise FALSE.
+    bool visit_node(uint32_t node, field_visitor& visitor, uint32_t& position) const;
+    /// \brief Visits a single instance of a node, recursively.
+    /// \param node The ID of the node to visit.
+    /// \param index The instance's index if it is an array element, otherwise 0.
+    /// \param visitor The visitor to pass the fields to.
+    /// \param position The position of the instance, which is updated to the position after it.
+    /// \returns TRUE if the instance was visited within the message's bounds, otherwise FALSE.
+    bool visit_instance(uint32_t node, uint32_t index, field_visitor& visitor, uint32_t& position) const;
 
     // FIELD READING
     /// \brief Reads data out of m_bytes.
@@ -221,39 +923,89 @@ private:
     T read_value(uint32_t position) const
     {
         // Using endian.h automatically assumes host is little endian. No need for conversion.
-        return *reinterpret_cast<T*>(&(introspector::m_bytes[position]));
+        return *reinterpret_cast<const T*>(&(introspector::m_bytes[position]));
     }
-    /// \brief Reads a field from the message.
+    /// \brief Reads a numeric field from the message.
     /// \tparam T The data type of the field to read.
-    /// \param path The path to read the field from.
-    /// \param type The field's primitive type.
+    /// \param field The field to read.
+    /// \param type The requested primitive type.
     /// \param value The value to store the field data in.
-    /// \returns TRUE if the path exists and the field was successfully read, otherwise FALSE.
+    /// \returns TRUE if the field type matches and was successfully read, otherwise FALSE.
     /// \note This can only be used on numeric primitive types, and the value type must match the primitive type.
     template<typename T>
-    bool get_field(const std::string& path, definition_t::primitive_type_t type, T& value) const
+    bool read_field(const field_t& field, definition_t::primitive_type_t type, T& value) const
     {
-        try
-        {
-            // Get field info from map.
-            auto field_info = introspector::m_field_map.at(path);
-
-            // Check field type.
-            if(field_info.primitive_type != type)
-            {
-                return false;
-            }
-
-            // Extract value.
-            value = introspector::read_value<T>(field_info.position);
-        }
-        catch(...)
+        // Check field type.
+        if(field.primitive_type != type)
         {
+            introspector::m_status = status_t::TYPE_MISMATCH;
             return false;
         }
 
+        // Extract value.
+        value = introspector::read_value<T>(field.position);
+
         return true;
     }
+    /// \brief Reads a string field from the message.
+    /// \param field The field to read.
+    /// \param value The value to store the field data in.
+    /// \returns TRUE if the field is a string and was successfully read, otherwise FALSE.
+    bool read_string(const field_t& field, std::string& value) const;
+    /// \brief Reads a view of a string field from the message.
+    /// \param field The field to read.
+    /// \param value The span to store the view of the string's characters in.
+    /// \returns TRUE if the field is a string, otherwise FALSE.
+    bool read_string(const field_t& field, span_t<char>& value) const;
+    /// \brief Reads the length of a string field in the message.
+    /// \param field The string field to read.
+    /// \param length The reference to store the string's number of characters in.
+    /// \returns TRUE if the length and the characters it counts lie within the message, otherwise FALSE.
+    bool read_string_length(const field_t& field, uint32_t& length) const;
+    /// \brief Reads a time field from the message.
+    /// \param field The field to read.
+    /// \param value The value to store the field data in.
+    /// \returns TRUE if the field is a time and was successfully read, otherwise FALSE.
+    bool read_time(const field_t& field, ros::Time& value) const;
+    /// \brief Reads a duration field from the message.
+    /// \param field The field to read.
+    /// \param value The value to store the field data in.
+    /// \returns TRUE if the field is a duration and was successfully read, otherwise FALSE.
+    bool read_duration(const field_t& field, ros::Duration& value) const;
+    /// \brief Reads any primitive field from the message as a number.
+    /// \param field The field to read.
+    /// \param value The value to store the field data in.
+    /// \returns TRUE if the field is primitive and was successfully read, otherwise FALSE.
+    /// \details String fields are parsed as numbers, and read as NaN if they are not numbers.
+    bool read_number(const field_t& field, double& value) const;
+    /// \brief Reads a fixed size primitive field from the message.
+    /// \tparam T The C++ type of the field, whose primitive type is given by primitive_traits_t.
+    /// \param field The field to read.
+    /// \param value The value to store the field data in.
+    /// \returns TRUE if the field type matches and was successfully read, otherwise FALSE.
+    template<typename T>
+    bool read_typed(const field_t& field, T& value) const
+    {
+        return introspector::read_field(field, primitive_traits_t<T>::type(), value);
+    }
+    /// \brief Reads a string field from the message.
+    bool read_typed(const field_t& field, std::string& value) const
+    {
+        return introspector::read_string(field, value);
+    }
+    /// \brief Reads a time field from the message.
+    bool read_typed(const field_t& field, ros::Time& value) const
+    {
+        return introspector::read_time(field, value);
+    }
+    /// \brief Reads a duration field from the message.
+    bool read_typed(const field_t& field, ros::Duration& value) const
+    {
+        return introspector::read_duration(field, value);
+    }
+    /// \brief Stores a string field while it is parsed as a number.
+    /// \details The buffer is reused so that reading string fields as numbers does not allocate.
+    mutable std::string m_number_string;
 };
 
 }
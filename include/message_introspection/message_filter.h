@@ -0,0 +1,257 @@
+/// \file message_introspection/message_filter.h
+/// \brief Defines the message_introspection::message_filter class.
+#ifndef MESSAGE_INTROSPECTION___MESSAGE_FILTER_H
+#define MESSAGE_INTROSPECTION___MESSAGE_FILTER_H
+
+#include "message_introspection/introspector.h"
+#include "message_introspection/field_handle.h"
+
+#include <rosbag/view.h>
+#include <rosbag/message_instance.h>
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace message_introspection {
+
+/// \brief Filters messages by a condition on their field values.
+/// \details A filter is compiled from an expression such as
+/// `status.level >= 2 && header.stamp > 1500000000.5 && header.frame_id == "map"`. Expressions compare
+/// field paths with numbers, strings, and other fields using ==, !=, <, <=, > and >=, and combine the
+/// comparisons with &&, || and !, grouped by parentheses. A path on its own is true if its field is not zero,
+/// or is a non-empty string.
+///
+/// The expression is compiled once into a short program of comparisons and jumps. Its paths are resolved
+/// to field handles once per message type, and each message is then evaluated directly on its serialized bytes.
+/// Comparisons are evaluated from left to right, and stop as soon as the result is known, so fields that are
+/// not needed to decide a message are never read. Numbers, times and durations are compared as in
+/// introspector::get_number(), and strings are compared in place without being copied.
+///
+/// A comparison whose field does not exist in the message, or whose types cannot be compared, is false.
+class message_filter
+{
+public:
+    // CONSTRUCTORS
+    /// \brief Creates an empty filter, which matches every message.
+    message_filter();
+    /// \brief Creates a new filter from an expression.
+    /// \param expression The filter's expression.
+    /// \details If the expression is invalid, the filter matches no message and error() describes the problem.
+    message_filter(const std::string& expression);
+    // The filter points into its own resolutions and owns an introspector, so it is not copied.
+    message_filter(const message_filter&) = delete;
+    message_filter& operator=(const message_filter&) = delete;
+
+    // EXPRESSION
+    /// \brief Compiles a new expression into the filter.
+    /// \param expression The filter's expression.
+    /// \returns TRUE if the expression was compiled, otherwise FALSE.
+    /// \details If the expression is invalid, the filter matches no message and error() describes the problem.
+    /// An empty expression matches every message.
+    bool compile(const std::string& expression);
+    /// \brief Gets the filter's expression.
+    /// \returns The expression that the filter was compiled from.
+    const std::string& expression() const;
+    /// \brief Gets the reason that the filter's expression could not be compiled.
+    /// \returns The error message, or an empty string if the expression was compiled.
+    const std::string& error() const;
+    /// \brief Gets the field paths that the expression reads.
+    /// \returns The paths, in the order that they first appear in the expression.
+    /// \details Passing these to introspector::set_interest() limits the indexing of messages to the filtered fields.
+    const std::vector<std::string>& paths() const;
+
+    // EVALUATE
+    /// \brief Indicates if an introspector's current message matches the filter.
+    /// \param introspector The introspector holding the message.
+    /// \returns TRUE if the message matches, otherwise FALSE.
+    /// \details The filter's paths are resolved with the introspector the first time each message type is evaluated.
+    /// Evaluating messages with the introspector that resolved them is fastest, since it caches the fields' positions.
+    bool matches(introspector& introspector);
+    /// \brief Indicates if a bag message matches the filter.
+    /// \param message The message to evaluate.
+    /// \returns TRUE if the message matches, otherwise FALSE.
+    /// \details The message is read by the filter's own introspector, which only indexes the message up to the
+    /// fields that the filter reads.
+    bool matches(const rosbag::MessageInstance& message);
+
+    // BATCH
+    /// \brief Passes every message of a bag view that matches the filter to a consumer.
+    /// \tparam consumer_t A callable with the signature void(const rosbag::MessageInstance&).
+    /// \param view The view to filter.
+    /// \param consume Receives each matching message, in bag order.
+    /// \returns The number of matching messages.
+    template<typename consumer_t>
+    uint64_t filter(rosbag::View& view, consumer_t consume)
+    {
+        return message_filter::filter(view.begin(), view.end(), consume);
+    }
+    /// \brief Passes every message of a range that matches the filter to a consumer.
+    /// \tparam iterator_t An iterator over rosbag::MessageInstance objects.
+    /// \tparam consumer_t A callable with the signature void(const rosbag::MessageInstance&).
+    /// \param begin The first message of the range.
+    /// \param end The end of the range.
+    /// \param consume Receives each matching message, in order.
+    /// \returns The number of matching messages.
+    template<typename iterator_t, typename consumer_t>
+    uint64_t filter(iterator_t begin, iterator_t end, consumer_t consume)
+    {
+        uint64_t n_matches = 0;
+        for(; begin != end; ++begin)
+        {
+            if(message_filter::matches(*begin))
+            {
+                consume(*begin);
+                ++n_matches;
+            }
+        }
+        return n_matches;
+    }
+
+private:
+    // PROGRAM
+    /// \brief An enumeration of comparison operators.
+    enum class comparison_t
+    {
+        EQUAL = 0,
+        NOT_EQUAL = 1,
+        LESS = 2,
+        LESS_EQUAL = 3,
+        GREATER = 4,
+        GREATER_EQUAL = 5,
+        TRUTH = 6
+    };
+    /// \brief An operand of a comparison.
+    struct operand_t
+    {
+        /// \brief An enumeration of operand kinds.
+        enum class kind_t
+        {
+            PATH = 0,
+            NUMBER = 1,
+            STRING = 2
+        };
+        /// \brief The kind of the operand.
+        kind_t kind;
+        /// \brief The index of the operand's path, if it is a path.
+        uint32_t path;
+        /// \brief The operand's value, if it is a number.
+        double number;
+        /// \brief The operand's value, if it is a string.
+        std::string text;
+    };
+    /// \brief A comparison between two operands, or the truth of a single operand.
+    struct condition_t
+    {
+        /// \brief The comparison's operator.
+        comparison_t comparison;
+        /// \brief The left operand, which is a path unless both operands are constants.
+        operand_t left;
+        /// \brief The right operand, which is unused if the comparison is TRUTH.
+        operand_t right;
+    };
+    /// \brief An enumeration of the program's instructions.
+    enum class opcode_t
+    {
+        /// \brief Sets the result to the outcome of a condition.
+        TEST = 0,
+        /// \brief Inverts the result.
+        NOT = 1,
+        /// \brief Jumps to an instruction if the result is FALSE.
+        JUMP_IF_FALSE = 2,
+        /// \brief Jumps to an instruction if the result is TRUE.
+        JUMP_IF_TRUE = 3
+    };
+    /// \brief A single instruction of the program.
+    struct instruction_t
+    {
+        /// \brief The instruction's operation.
+        opcode_t opcode;
+        /// \brief The index of the condition for TEST, or of the target instruction for jumps.
+        uint32_t argument;
+    };
+
+    /// \brief Stores the filter's expression.
+    std::string m_expression;
+    /// \brief Stores the reason that the expression could not be compiled.
+    std::string m_error;
+    /// \brief Stores the paths that the expression reads.
+    std::vector<std::string> m_paths;
+    /// \brief Stores the expression's conditions.
+    std::vector<condition_t> m_conditions;
+    /// \brief Stores the program, which leaves the filter's result in a single flag.
+    std::vector<instruction_t> m_program;
+    /// \brief Indicates if the expression was compiled.
+    bool m_compiled;
+
+    // PARSING
+    /// \brief Stores the position of the parser within the expression.
+    size_t m_position;
+    /// \brief Parses a disjunction of conjunctions.
+    /// \returns TRUE if the disjunction was parsed, otherwise FALSE.
+    bool parse_or();
+    /// \brief Parses a conjunction of unary terms.
+    /// \returns TRUE if the conjunction was parsed, otherwise FALSE.
+    bool parse_and();
+    /// \brief Parses a negation, a parenthesized expression, or a condition.
+    /// \returns TRUE if the term was parsed, otherwise FALSE.
+    bool parse_unary();
+    /// \brief Parses a comparison, or a single operand whose truth is tested.
+    /// \returns TRUE if the condition was parsed, otherwise FALSE.
+    bool parse_condition();
+    /// \brief Parses a path, number, string or boolean operand.
+    /// \param operand The operand to store the result in.
+    /// \returns TRUE if the operand was parsed, otherwise FALSE.
+    bool parse_operand(operand_t& operand);
+    /// \brief Skips whitespace and consumes a token if it is next in the expression.
+    /// \param token The token to consume.
+    /// \returns TRUE if the token was consumed, otherwise FALSE.
+    bool accept(const char* token);
+    /// \brief Records a parsing error at the current position.
+    /// \param message The description of the error.
+    /// \returns FALSE, so that parsers can return the result directly.
+    bool fail(const std::string& message);
+
+    // RESOLUTION
+    /// \brief The conditions of the expression resolved against a message type.
+    struct resolution_t
+    {
+        /// \brief The handles of the expression's paths, which are unresolved if a path does not exist.
+        std::vector<field_handle_t> handles;
+        /// \brief The index of a resolved handle, which identifies the message type, or the number of handles if there is none.
+        uint32_t probe;
+        /// \brief Indicates for each condition if its operands can be compared in this message type.
+        std::vector<uint8_t> comparable;
+        /// \brief Indicates for each condition if its operands are strings rather than numbers.
+        std::vector<uint8_t> strings;
+    };
+    /// \brief Stores the resolutions of each message type, keyed by schema ID.
+    std::unordered_map<uint64_t, resolution_t> m_resolutions;
+    /// \brief Points to the resolution of the most recent message type.
+    const resolution_t* m_current_resolution;
+    /// \brief Gets the resolution of an introspector's current message type, resolving it if the type is new.
+    /// \param introspector The introspector holding the message.
+    /// \returns The resolution, or nullptr if the introspector holds no message type.
+    const resolution_t* resolve(introspector& introspector);
+
+    // EVALUATION
+    /// \brief Evaluates a condition on an introspector's current message.
+    /// \param introspector The introspector holding the message.
+    /// \param resolution The resolution of the message's type.
+    /// \param c The index of the condition.
+    /// \returns The outcome of the condition.
+    bool test(const introspector& introspector, const resolution_t& resolution, uint32_t c) const;
+    /// \brief Indicates if a comparison holds for two ordered operands.
+    /// \param comparison The comparison's operator.
+    /// \param order The order of the operands: -1 if less, 0 if equal, 1 if greater, or 2 if they are unordered.
+    /// \returns TRUE if the comparison holds, otherwise FALSE.
+    static bool holds(comparison_t comparison, int32_t order);
+
+    // BAG MESSAGES
+    /// \brief The introspector that reads bag messages.
+    introspector m_introspector;
+};
+
+}
+
+#endif
\ No newline at end of file
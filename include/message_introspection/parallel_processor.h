@@ -0,0 +1,119 @@
+/// \file message_introspection/parallel_processor.h
+/// \brief Defines the message_introspection::parallel_processor class.
+#ifndef MESSAGE_INTROSPECTION___PARALLEL_PROCESSOR_H
+#define MESSAGE_INTROSPECTION___PARALLEL_PROCESSOR_H
+
+#include "message_introspection/introspector.h"
+
+#include <rosbag/view.h>
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+
+namespace message_introspection {
+
+/// \brief Decodes bag messages on a pool of worker threads, and delivers their results in bag order.
+/// \details The calling thread reads each message's serialized bytes from the bag, since bags can only be read
+/// by one thread. Worker threads then decode the messages, each with its own introspector over the shared schemas
+/// in the registry. Workers claim the next unclaimed message whenever they finish one, so large and small messages
+/// are balanced across the pool. Results are passed back to the calling thread strictly in bag order.
+///
+/// Messages move through a fixed window of slots, which bounds memory use. Slots, their byte buffers and their
+/// results are reused, so the steady state does not allocate memory beyond what the decoder itself allocates.
+class parallel_processor
+{
+public:
+    // TYPES
+    /// \brief Describes a message that is being processed.
+    struct message_info_t
+    {
+        /// \brief The message's position in the view, starting from zero.
+        uint64_t sequence;
+        /// \brief The message's topic, which stays valid while the bag is open.
+        const std::string* topic;
+        /// \brief The message's bag timestamp.
+        ros::Time time;
+    };
+
+    // CONSTRUCTORS
+    /// \brief Creates a new parallel processor.
+    /// \param n_threads The number of worker threads. Zero uses one thread per hardware core.
+    /// \param window The number of messages that may be in flight at once. Zero uses 16 per worker thread.
+    parallel_processor(uint32_t n_threads = 0, uint32_t window = 0);
+
+    // PROPERTIES
+    /// \brief Gets the number of worker threads.
+    /// \returns The number of worker threads.
+    uint32_t n_threads() const;
+    /// \brief Gets the number of messages that may be in flight at once.
+    /// \returns The window size.
+    uint32_t window() const;
+
+    // PROCESS
+    /// \brief Processes every message in a bag view.
+    /// \tparam result_t The type of each message's result, which must be default constructible.
+    /// \tparam decoder_t A callable with the signature void(introspector&, const message_info_t&, result_t&).
+    /// \tparam consumer_t A callable with the signature void(const message_info_t&, const result_t&).
+    /// \param view The view to process.
+    /// \param decode Reads a message on a worker thread. The introspector holds the message, and the result
+    /// is reused between messages, so its storage can be kept to avoid allocating memory.
+    /// \param consume Receives each message's result on the calling thread, in bag order.
+    /// \returns The number of messages processed.
+    /// \details The decoder is called from several threads at once, so it must only modify its result.
+    /// If the decoder or consumer throws, processing stops and the exception is rethrown on the calling thread.
+    template<typename result_t, typename decoder_t, typename consumer_t>
+    uint64_t process(rosbag::View& view, decoder_t decode, consumer_t consume)
+    {
+        // Each slot of the window has a result that is reused for every message that passes through it.
+        // Results are separate objects rather than a vector, since std::vector<bool> packs its elements into shared
+        // words that workers can't write concurrently.
+        std::unique_ptr<result_t[]> results(new result_t[parallel_processor::m_window]());
+
+        return parallel_processor::run(view,
+                                       [&](introspector& message, const message_info_t& info, uint32_t slot){decode(message, info, results[slot]);},
+                                       [&](const message_info_t& info, uint32_t slot){consume(info, results[slot]);});
+    }
+
+private:
+    // CONFIG
+    /// \brief Stores the number of worker threads.
+    uint32_t m_n_threads;
+    /// \brief Stores the window size.
+    uint32_t m_window;
+
+    // SLOTS
+    /// \brief A message in flight.
+    struct slot_t
+    {
+        /// \brief The message's serialized bytes, which only grow.
+        std::vector<uint8_t> bytes;
+        /// \brief The length of the message's serialized bytes.
+        uint32_t length;
+        /// \brief The message's MD5 hash.
+        const std::string* md5;
+        /// \brief The message's ROS type.
+        const std::string* type;
+        /// \brief The message's definition string.
+        const std::string* definition;
+        /// \brief The message's information.
+        message_info_t info;
+        /// \brief Indicates if a worker has finished decoding the message.
+        bool decoded;
+    };
+    /// \brief Stores the window's slots.
+    std::vector<slot_t> m_slots;
+
+    // RUN
+    /// \brief Runs the worker threads over a view.
+    /// \param view The view to process.
+    /// \param decode Decodes the message in a slot on a worker thread.
+    /// \param consume Consumes the result in a slot on the calling thread.
+    /// \returns The number of messages processed.
+    uint64_t run(rosbag::View& view, const std::function<void(introspector&, const message_info_t&, uint32_t)>& decode, const std::function<void(const message_info_t&, uint32_t)>& consume);
+};
+
+}
+
+#endif
\ No newline at end of file
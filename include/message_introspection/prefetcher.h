@@ -0,0 +1,120 @@
+/// \file message_introspection/prefetcher.h
+/// \brief Defines the message_introspection::prefetcher class.
+#ifndef MESSAGE_INTROSPECTION___PREFETCHER_H
+#define MESSAGE_INTROSPECTION___PREFETCHER_H
+
+#include "message_introspection/introspector.h"
+
+#include <rosbag/view.h>
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <chrono>
+
+namespace message_introspection {
+
+/// \brief Reads messages from a bag view ahead of the thread that introspects them.
+/// \details A background thread iterates the view, which loads and decompresses the bag's chunks, and copies
+/// each message's bytes into a bounded queue. The introspection thread takes ready messages from the queue,
+/// so it only waits on the bag when the reader falls behind. The time spent waiting is tracked, which shows
+/// whether the bag or the introspection is the bottleneck.
+///
+/// The queue's slots and their byte buffers are reused, so the steady state does not allocate memory.
+class prefetcher
+{
+public:
+    // CONSTRUCTORS
+    /// \brief Creates a new prefetcher and starts reading the view.
+    /// \param view The view to read. It must not be used by any other thread, and must outlive the prefetcher.
+    /// \param capacity The maximum number of messages that are read ahead.
+    prefetcher(rosbag::View& view, uint32_t capacity = 64);
+    /// \brief Stops reading the view.
+    ~prefetcher();
+    // The reader thread refers to the prefetcher, so it is not copied.
+    prefetcher(const prefetcher&) = delete;
+    prefetcher& operator=(const prefetcher&) = delete;
+
+    // MESSAGES
+    /// \brief Passes the next message to an introspector.
+    /// \param introspector The introspector to pass the message to.
+    /// \returns TRUE if a message was passed, or FALSE if there are no more messages.
+    /// \details The introspector reads directly from the queue's memory, so the message is valid until
+    /// next() is called again. If reading the bag failed, the reader's exception is rethrown here.
+    bool next(introspector& introspector);
+    /// \brief Gets the topic of the current message.
+    /// \returns The current message's topic, or an empty string if next() has not passed a message yet.
+    const std::string& topic() const;
+    /// \brief Gets the bag timestamp of the current message.
+    /// \returns The current message's bag timestamp, or zero if next() has not passed a message yet.
+    ros::Time time() const;
+
+    // STATISTICS
+    /// \brief Gets the total time that next() waited for the reader.
+    /// \returns The time spent waiting for messages.
+    std::chrono::nanoseconds idle_time() const;
+    /// \brief Gets the number of times that next() had to wait for the reader.
+    /// \returns The number of waits.
+    uint64_t n_stalls() const;
+
+private:
+    // SLOTS
+    /// \brief A message in the queue.
+    struct slot_t
+    {
+        /// \brief The message's serialized bytes, which only grow.
+        std::vector<uint8_t> bytes;
+        /// \brief The length of the message's serialized bytes.
+        uint32_t length;
+        /// \brief The message's MD5 hash.
+        const std::string* md5;
+        /// \brief The message's ROS type.
+        const std::string* type;
+        /// \brief The message's definition string.
+        const std::string* definition;
+        /// \brief The message's topic.
+        const std::string* topic;
+        /// \brief The message's bag timestamp.
+        ros::Time time;
+    };
+    /// \brief The queue's slots, used as a ring.
+    /// \details One slot more than the capacity is kept, so the current message's slot is not refilled while it is read.
+    std::vector<slot_t> m_slots;
+    /// \brief The number of messages read from the view.
+    uint64_t m_n_read;
+    /// \brief The number of messages taken by next().
+    uint64_t m_n_taken;
+    /// \brief Indicates if the reader has reached the end of the view.
+    bool m_finished;
+    /// \brief Indicates if the reader should stop early.
+    bool m_stop;
+    /// \brief Stores an exception thrown while reading the view.
+    std::exception_ptr m_error;
+
+    // READER
+    /// \brief The view being read.
+    rosbag::View& m_view;
+    /// \brief Protects the queue's state and statistics.
+    mutable std::mutex m_mutex;
+    /// \brief Signals the reader when a slot is freed.
+    std::condition_variable m_freed_condition;
+    /// \brief Signals next() when a message is read.
+    std::condition_variable m_read_condition;
+    /// \brief The background thread that reads the view.
+    std::thread m_reader;
+    /// \brief Reads the view into the queue until the view ends or the prefetcher stops.
+    void read_view();
+
+    // STATISTICS
+    /// \brief Stores the total time that next() waited for the reader.
+    std::chrono::nanoseconds m_idle_time;
+    /// \brief Stores the number of times that next() waited for the reader.
+    uint64_t m_n_stalls;
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,96 @@
+/// \file message_introspection/primitive_traits.h
+/// \brief Defines the message_introspection::primitive_traits_t class.
+#ifndef MESSAGE_INTROSPECTION___PRIMITIVE_TRAITS_H
+#define MESSAGE_INTROSPECTION___PRIMITIVE_TRAITS_H
+
+#include "message_introspection/definition.h"
+
+namespace message_introspection {
+
+/// \brief Maps a C++ type to the fixed size primitive type that it reads.
+/// \tparam T The C++ type.
+/// \details Only specializations are defined, so unsupported types fail to compile.
+template<typename T>
+struct primitive_traits_t;
+
+/// \brief Maps bool to BOOL.
+template<>
+struct primitive_traits_t<bool>
+{
+    /// \brief Gets the primitive type.
+    static constexpr definition_t::primitive_type_t type() { return definition_t::primitive_type_t::BOOL; }
+};
+/// \brief Maps int8_t to INT8.
+template<>
+struct primitive_traits_t<int8_t>
+{
+    /// \brief Gets the primitive type.
+    static constexpr definition_t::primitive_type_t type() { return definition_t::primitive_type_t::INT8; }
+};
+/// \brief Maps int16_t to INT16.
+template<>
+struct primitive_traits_t<int16_t>
+{
+    /// \brief Gets the primitive type.
+    static constexpr definition_t::primitive_type_t type() { return definition_t::primitive_type_t::INT16; }
+};
+/// \brief Maps int32_t to INT32.
+template<>
+struct primitive_traits_t<int32_t>
+{
+    /// \brief Gets the primitive type.
+    static constexpr definition_t::primitive_type_t type() { return definition_t::primitive_type_t::INT32; }
+};
+/// \brief Maps int64_t to INT64.
+template<>
+struct primitive_traits_t<int64_t>
+{
+    /// \brief Gets the primitive type.
+    static constexpr definition_t::primitive_type_t type() { return definition_t::primitive_type_t::INT64; }
+};
+/// \brief Maps uint8_t to UINT8.
+template<>
+struct primitive_traits_t<uint8_t>
+{
+    /// \brief Gets the primitive type.
+    static constexpr definition_t::primitive_type_t type() { return definition_t::primitive_type_t::UINT8; }
+};
+/// \brief Maps uint16_t to UINT16.
+template<>
+struct primitive_traits_t<uint16_t>
+{
+    /// \brief Gets the primitive type.
+    static constexpr definition_t::primitive_type_t type() { return definition_t::primitive_type_t::UINT16; }
+};
+/// \brief Maps uint32_t to UINT32.
+template<>
+struct primitive_traits_t<uint32_t>
+{
+    /// \brief Gets the primitive type.
+    static constexpr definition_t::primitive_type_t type() { return definition_t::primitive_type_t::UINT32; }
+};
+/// \brief Maps uint64_t to UINT64.
+template<>
+struct primitive_traits_t<uint64_t>
+{
+    /// \brief Gets the primitive type.
+    static constexpr definition_t::primitive_type_t type() { return definition_t::primitive_type_t::UINT64; }
+};
+/// \brief Maps float to FLOAT32.
+template<>
+struct primitive_traits_t<float>
+{
+    /// \brief Gets the primitive type.
+    static constexpr definition_t::primitive_type_t type() { return definition_t::primitive_type_t::FLOAT32; }
+};
+/// \brief Maps double to FLOAT64.
+template<>
+struct primitive_traits_t<double>
+{
+    /// \brief Gets the primitive type.
+    static constexpr definition_t::primitive_type_t type() { return definition_t::primitive_type_t::FLOAT64; }
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,43 @@
+/// \file message_introspection/registry.h
+/// \brief Defines the message_introspection::registry class.
+#ifndef MESSAGE_INTROSPECTION___REGISTRY_H
+#define MESSAGE_INTROSPECTION___REGISTRY_H
+
+#include "message_introspection/schema.h"
+
+#include <memory>
+#include <string>
+
+namespace message_introspection {
+
+/// \brief A process-wide registry of message schemas.
+/// \details Each message type is parsed once per process, and its schema is shared by every
+/// introspector that reads it. Schemas are immutable, so they can be used by introspectors on
+/// any number of threads at the same time. All methods are thread safe.
+class registry
+{
+public:
+    // SCHEMAS
+    /// \brief Gets the schema of a message type, parsing and registering it if it is not registered yet.
+    /// \param md5 The message's MD5 hash.
+    /// \param type The message's ROS type.
+    /// \param definition The message's definition string.
+    /// \returns The message type's shared schema.
+    /// \details The definition is parsed without holding the registry's lock, so threads registering
+    /// different types do not wait on each other.
+    static std::shared_ptr<const schema_t> get_schema(const std::string& md5, const std::string& type, const std::string& definition);
+    /// \brief Finds the schema of a registered message type.
+    /// \param md5 The message's MD5 hash.
+    /// \returns The message type's shared schema, or nullptr if the type is not registered.
+    static std::shared_ptr<const schema_t> find_schema(const std::string& md5);
+    /// \brief Gets the number of registered message types.
+    /// \returns The number of registered message types.
+    static size_t size();
+    /// \brief Removes all message types from the registry.
+    /// \details Schemas that are still in use by introspectors stay valid until they are no longer used.
+    static void clear();
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,302 @@
+/// \file message_introspection/schema.h
+/// \brief Defines the message_introspection::schema_t class.
+#ifndef MESSAGE_INTROSPECTION___SCHEMA_H
+#define MESSAGE_INTROSPECTION___SCHEMA_H
+
+#include "message_introspection/definition.h"
+#include "message_introspection/definition_tree.h"
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+
+namespace message_introspection {
+
+/// \brief The parsed definition of a registered message type.
+/// \details A schema holds everything that is derived from a message type's definition string:
+/// the component definitions, the message's nodes, and the compiled decoder plan.
+/// It does not change once it has been created.
+class schema_t
+{
+public:
+    // NODES
+    /// \brief A compact node of the message's definition tree.
+    /// \details All nodes of a message are stored in one contiguous array, and refer to each other by index.
+    /// Type and name strings are interned, so each distinct string is stored once per schema.
+    struct node_t
+    {
+        /// \brief The node's field name, which is empty for the top level message.
+        const std::string* name;
+        /// \brief The node's ROS type.
+        const std::string* type;
+        /// \brief The node's primitive type.
+        definition_t::primitive_type_t primitive_type;
+        /// \brief The node's array type.
+        definition_t::array_type_t array_type;
+        /// \brief The node's array length, if it is a fixed length array.
+        uint32_t array_length;
+        /// \brief The node's size, as reported by definition_t::size().
+        uint32_t size;
+        /// \brief Indicates if every instance of the node has the same serialized size.
+        bool fixed_size;
+        /// \brief The serialized size of a single instance, if it has a fixed size.
+        uint32_t serialized_size;
+        /// \brief The ID of the node's parent. The top level message is its own parent.
+        uint32_t parent;
+        /// \brief The ID of the node's first field. The node's fields have consecutive IDs.
+        uint32_t first_field;
+        /// \brief The number of fields in the node.
+        uint32_t n_fields;
+
+        /// \brief Indicates if the node is a primitive.
+        /// \returns TRUE if the node is a primitive, otherwise FALSE.
+        bool is_primitive() const
+        {
+            return node_t::primitive_type != definition_t::primitive_type_t::NON_PRIMITIVE;
+        }
+        /// \brief Indicates if the node is an array.
+        /// \returns TRUE if the node is an array, otherwise FALSE.
+        bool is_array() const
+        {
+            return node_t::array_type != definition_t::array_type_t::NONE;
+        }
+    };
+
+    // CONSTRUCTORS
+    /// \brief Parses a message definition into a new schema.
+    /// \param md5 The message's MD5 hash.
+    /// \param type The message's ROS type.
+    /// \param definition The message's definition string.
+    schema_t(const std::string& md5, const std::string& type, const std::string& definition);
+    // Nodes point to the schema's interned strings, so schemas are not copied.
+    schema_t(const schema_t&) = delete;
+    schema_t& operator=(const schema_t&) = delete;
+
+    // PROPERTIES
+    /// \brief Gets the message's MD5 hash.
+    /// \returns The MD5 hash.
+    const std::string& md5() const;
+    /// \brief Gets the message's ROS type.
+    /// \returns The ROS type.
+    const std::string& type() const;
+    /// \brief Gets the schema's unique ID.
+    /// \returns The ID, which is never reused within the process.
+    uint64_t id() const;
+    /// \brief Gets the message's definition tree.
+    /// \returns A reference to the definition tree.
+    /// \details The definition tree is built from the message's nodes and indexed for path queries the first time it is requested.
+    const definition_tree_t& definition_tree() const;
+    /// \brief Gets the number of nodes in the message.
+    /// \returns The number of nodes, including the top level message.
+    uint32_t n_nodes() const;
+    /// \brief Gets a node of the message by its ID.
+    /// \param node The node's ID, from 0 for the top level message up to n_nodes() - 1.
+    /// \returns A reference to the node.
+    /// \details Node IDs are assigned in the same order for every schema of a message type. A parent's
+    /// fields have consecutive IDs in the order they are defined.
+    const node_t& node(uint32_t node) const;
+
+    // PRINTING
+    /// \brief Prints the message's component definitions to a string.
+    /// \returns The component definitions.
+    std::string print_components() const;
+    /// \brief Prints the message's definition tree to a string.
+    /// \returns The message's definition tree.
+    std::string print_definition_tree() const;
+
+private:
+    // The introspector runs the decoder plan and positions fields with the layout.
+    friend class introspector;
+
+    // PROPERTIES
+    /// \brief Stores the message's MD5 hash.
+    std::string m_md5;
+    /// \brief Stores the message's ROS type.
+    std::string m_type;
+    /// \brief Stores the schema's unique ID.
+    uint64_t m_id;
+
+    // COMPONENTS
+    /// \brief A map of component message definitions (top level only)
+    std::unordered_map<std::string, std::vector<definition_t>> m_component_definitions;
+    /// \brief Parses a message definition string into the component definition map.
+    /// \param message_type The ROS message type string.
+    /// \param definition The ROS message definition string.
+    /// \details The definition is scanned in place in a single pass. Field types are then resolved to the exact
+    /// name of their component, qualifying unqualified types with the package of the message that contains them.
+    void parse_components(const std::string& message_type, const std::string& definition);
+    /// \brief Skips the whitespace at the start of a range of characters.
+    /// \param begin The start of the range.
+    /// \param end The end of the range.
+    /// \returns The first character that is not whitespace, or the end of the range.
+    static const char* skip_whitespace(const char* begin, const char* end);
+    /// \brief Skips the token at the start of a range of characters.
+    /// \param begin The start of the range, which is the start of the token.
+    /// \param end The end of the range.
+    /// \returns The first character after the token.
+    static const char* skip_token(const char* begin, const char* end);
+
+    // NODES
+    /// \brief Stores each distinct type and name string of the message once.
+    /// \details Elements of an unordered set are never moved, so nodes can point to them.
+    std::unordered_set<std::string> m_strings;
+    /// \brief Gets the interned copy of a string.
+    /// \param string The string to intern.
+    /// \returns A pointer to the interned string.
+    const std::string* intern(const std::string& string);
+    /// \brief The message's nodes, with the top level message first.
+    std::vector<node_t> m_nodes;
+    /// \brief Creates a node from a component definition.
+    /// \param definition The component definition of the node.
+    /// \param parent The ID of the node's parent.
+    /// \returns The new node.
+    node_t create_node(const definition_t& definition, uint32_t parent);
+    /// \brief Adds the fields of a non-primitive node, recursively.
+    /// \param node The ID of the node whose fields are added.
+    /// \details The node's fields are added contiguously, and its size is computed from them.
+    void add_fields(uint32_t node);
+
+    // DEFINITION
+    /// \brief The message's calculated definition tree, which is built on first use.
+    mutable definition_tree_t m_definition_tree;
+    /// \brief Ensures the definition tree is only built once, even when requested from several threads.
+    mutable std::once_flag m_definition_tree_built;
+    /// \brief A recursive method for building the definition tree from the message's nodes.
+    /// \param parent_path The parent path of the definition tree being built.
+    /// \param definition_tree A reference to the definition tree to build.
+    /// \param node The ID of the node that the definition tree is built from.
+    void build_definition_tree(const std::string& parent_path, definition_tree_t& definition_tree, uint32_t node) const;
+
+    // LAYOUT
+    /// \brief Describes where a node is found in a message.
+    /// \details A scope is the top level message, or one element of an array whose elements have variable sizes.
+    /// Within a scope, strings and arrays are anchors, since their positions and sizes depend on the message.
+    /// Every other node lies at a fixed offset from the end of the anchor before it, so a message only needs
+    /// to index its anchors, and all other positions are computed arithmetically.
+    struct layout_t
+    {
+        /// \brief The slot of the anchor that the node's offset is relative to, or -1 for the start of its scope.
+        int32_t anchor;
+        /// \brief The node's offset from the end of its anchor, or from the start of its scope.
+        /// \details Nodes inside an array of fixed size elements instead store their offset from the start of their parent.
+        uint32_t offset;
+        /// \brief The node's own anchor slot within its scope, if it is an anchor.
+        uint32_t slot;
+        /// \brief The number of anchors in the scope of each element, if the node is an array of variable sized elements.
+        /// \details The top level node stores the number of anchors in the message's scope.
+        uint32_t anchors;
+    };
+    /// \brief The layout of each node, indexed by node ID.
+    std::vector<layout_t> m_layout;
+    /// \brief Stores the offsets of a fixed size instance's fields from the start of the instance, recursively.
+    /// \param node The ID of the instance's node.
+    void layout_instance(uint32_t node);
+    /// \brief Indicates if a node is an array that is part of its scope's fixed size runs.
+    /// \param node The node.
+    /// \returns TRUE if the node is a fixed length array of fixed size elements, otherwise FALSE.
+    static bool is_folded(const node_t& node);
+
+    // PLAN
+    /// \brief An enumeration of decoder plan operation codes.
+    enum class opcode_t
+    {
+        /// \brief Advances the current position by a fixed number of bytes.
+        ADVANCE = 0,
+        /// \brief Indexes a string anchor at the current position and advances past it.
+        STRING = 1,
+        /// \brief Indexes an array anchor, either jumping over its elements or looping through them.
+        ARRAY = 2,
+        /// \brief Ends an array element, looping back to the start of the array's body for the next element.
+        END_ARRAY = 3
+    };
+    /// \brief A single operation in the decoder plan.
+    struct instruction_t
+    {
+        /// \brief The operation's code.
+        opcode_t opcode;
+        /// \brief The anchor slot of a STRING or ARRAY operation within its scope.
+        uint32_t slot;
+        /// \brief The number of bytes of an ADVANCE operation.
+        uint32_t size;
+        /// \brief The element count of a fixed length ARRAY operation, or zero if the count is serialized.
+        uint32_t count;
+        /// \brief The element size of an ARRAY operation whose elements have a fixed size.
+        /// \details ARRAY operations whose elements have variable sizes use zero.
+        uint32_t stride;
+        /// \brief The number of anchors in the scope of each element of an ARRAY operation whose elements have variable sizes.
+        uint32_t anchors;
+        /// \brief The index of an ARRAY operation's END_ARRAY operation, or an END_ARRAY operation's ARRAY operation.
+        uint32_t jump;
+    };
+    /// \brief The message's decoder plan, compiled from the definition tree.
+    /// \details The plan is a flat list of operations. Runs of fixed size fields are collapsed into a single
+    /// ADVANCE, and arrays of fixed size elements are jumped over in one step, so only strings and arrays of
+    /// variable sized elements require work for each message.
+    std::vector<instruction_t> m_plan;
+    /// \brief Tracks the anchors of a scope while the decoder plan is compiled.
+    struct scope_t
+    {
+        /// \brief The slot of the most recent anchor, or -1 if there is none yet.
+        int32_t anchor;
+        /// \brief The number of anchors in the scope.
+        uint32_t anchors;
+    };
+    /// \brief Describes the part of the decoder plan that indexes the first fields of the message.
+    struct prefix_t
+    {
+        /// \brief The index of the first operation that belongs to a later field.
+        uint32_t plan_end;
+        /// \brief The size of the fixed size fields at the end of the prefix that are not yet advanced over by the plan.
+        uint32_t run_size;
+    };
+    /// \brief The prefix of the decoder plan for each number of top level fields, from zero up to all of them.
+    /// \details Running the plan up to a prefix's end indexes every anchor of the prefix's fields, so the plan can stop
+    /// early when only the first fields of a message are read.
+    std::vector<prefix_t> m_prefixes;
+    /// \brief Compiles the fields of a non-primitive node into the decoder plan.
+    /// \param node The index of the node whose fields are compiled.
+    /// \param scope The scope that the fields belong to.
+    /// \param run_size The size of the current run of fixed size fields, which is flushed as an ADVANCE as needed.
+    void compile_fields(uint32_t node, scope_t& scope, uint32_t& run_size);
+    /// \brief Compiles a single node into the decoder plan.
+    /// \param node The index of the node to compile.
+    /// \param scope The scope that the node belongs to.
+    /// \param run_size The size of the current run of fixed size fields, which is flushed as an ADVANCE as needed.
+    void compile_definition(uint32_t node, scope_t& scope, uint32_t& run_size);
+    /// \brief Ends the current run of fixed size fields by adding an ADVANCE to the decoder plan.
+    /// \param run_size The size of the current run, which is reset to zero.
+    void flush_run(uint32_t& run_size);
+
+    // PATTERNS
+    /// \brief A path with its array indices removed, resolved against the definition tree.
+    /// \details Patterns are written like "markers[].pose.position.x", so one pattern covers every element of an array.
+    struct pattern_t
+    {
+        /// \brief Indicates if the pattern leads to a primitive field or a whole primitive array.
+        bool valid;
+        /// \brief A single part of a pattern.
+        struct part_t
+        {
+            /// \brief The index of the field within its parent's fields.
+            uint32_t field;
+            /// \brief Indicates if the part is an indexed array.
+            bool indexed;
+        };
+        /// \brief The parts of the pattern, from the top level message to the pattern's node.
+        std::vector<part_t> parts;
+        /// \brief Indicates if the pattern ends with an array that has no index.
+        bool whole_array;
+        /// \brief The primitive type of the pattern's node.
+        definition_t::primitive_type_t primitive_type;
+    };
+    /// \brief Resolves a pattern against the definition tree.
+    /// \param pattern The pattern to resolve, with empty brackets on each indexed array.
+    /// \param resolved The resolved pattern, which is invalid if the pattern does not lead to a primitive node.
+    void resolve_pattern(const std::string& pattern, pattern_t& resolved) const;
+};
+
+}
+
+#endif
\ No newline at end of file
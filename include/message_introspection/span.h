@@ -0,0 +1,87 @@
+/// \file message_introspection/span.h
+/// \brief Defines the message_introspection::span_t class.
+#ifndef MESSAGE_INTROSPECTION___SPAN_H
+#define MESSAGE_INTROSPECTION___SPAN_H
+
+#include <cstdint>
+#include <cstring>
+
+namespace message_introspection {
+
+/// \brief A read-only view of a primitive array inside a message's serialized bytes.
+/// \tparam T The element type of the array.
+/// \details A span does not copy the array. It is valid until the introspector that created it receives
+/// a new message. Elements are not necessarily aligned within the serialized bytes, so they are read by value.
+template<typename T>
+class span_t
+{
+public:
+    // CONSTRUCTORS
+    /// \brief Creates an empty span.
+    span_t()
+    {
+        span_t::m_data = nullptr;
+        span_t::m_size = 0;
+    }
+    /// \brief Creates a span over serialized array elements.
+    /// \param data A pointer to the first element's serialized bytes.
+    /// \param size The number of elements.
+    span_t(const uint8_t* data, uint32_t size)
+    {
+        span_t::m_data = data;
+        span_t::m_size = size;
+    }
+
+    // PROPERTIES
+    /// \brief Gets the number of elements in the span.
+    /// \returns The number of elements.
+    uint32_t size() const
+    {
+        return span_t::m_size;
+    }
+    /// \brief Indicates if the span has no elements.
+    /// \returns TRUE if the span is empty, otherwise FALSE.
+    bool empty() const
+    {
+        return span_t::m_size == 0;
+    }
+    /// \brief Gets the serialized bytes of the span's elements.
+    /// \returns A pointer to the first element's bytes, which are size() * sizeof(T) bytes long.
+    /// \details For uint8 arrays such as image data, this gives direct access to the message's bytes without copying them.
+    const uint8_t* bytes() const
+    {
+        return span_t::m_data;
+    }
+
+    // ACCESS
+    /// \brief Reads an element of the span.
+    /// \param index The index of the element to read.
+    /// \returns The element's value.
+    /// \note The index is not bounds checked.
+    T operator[](uint32_t index) const
+    {
+        // Using endian.h automatically assumes host is little endian. No need for conversion.
+        T value;
+        std::memcpy(&value, span_t::m_data + static_cast<size_t>(index) * sizeof(T), sizeof(T));
+        return value;
+    }
+    /// \brief Copies all elements of the span.
+    /// \param destination The array to copy the elements to, which must hold at least size() elements.
+    void copy(T* destination) const
+    {
+        if(span_t::m_size != 0)
+        {
+            std::memcpy(destination, span_t::m_data, static_cast<size_t>(span_t::m_size) * sizeof(T));
+        }
+    }
+
+private:
+    /// \brief Points to the serialized bytes of the first element.
+    const uint8_t* m_data;
+    /// \brief Stores the number of elements.
+    uint32_t m_size;
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,132 @@
+#include "message_introspection/batch_extractor.h"
+
+using namespace message_introspection;
+
+// CONSTRUCTORS
+batch_extractor::batch_extractor(const std::vector<std::string>& paths)
+{
+    // Set up a column for each path.
+    batch_extractor::m_paths = paths;
+    batch_extractor::m_values.resize(paths.size());
+    batch_extractor::m_valid.resize(paths.size());
+    batch_extractor::m_row_values.resize(paths.size());
+    batch_extractor::m_row_valid.resize(paths.size());
+    batch_extractor::m_unresolved.resize(paths.size());
+
+    // Only a few fields are read from each message, so messages are indexed on the first read.
+    batch_extractor::m_introspector.set_lazy(true);
+
+    // No message type has been read yet.
+    batch_extractor::m_current_resolution = nullptr;
+}
+
+// EXTRACT
+uint32_t batch_extractor::extract(rosbag::View& view)
+{
+    // Make room for the view's messages up front.
+    batch_extractor::reserve(batch_extractor::m_stamps.size() + view.size());
+
+    return batch_extractor::extract(view.begin(), view.end());
+}
+void batch_extractor::add_message(const rosbag::MessageInstance& message)
+{
+    // Read the message, which reuses the introspector's buffer and cached schema.
+    batch_extractor::m_introspector.new_message(message);
+
+    // Get the handles of the message's type.
+    const std::vector<field_handle_t>& handles = batch_extractor::get_handles();
+
+    // Read the row's values in one batch.
+    batch_extractor::m_introspector.get_numbers(handles, batch_extractor::m_row_values.data(), batch_extractor::m_row_valid.data());
+
+    // Add the row.
+    batch_extractor::m_stamps.push_back(message.getTime());
+    for(uint32_t column = 0; column < handles.size(); ++column)
+    {
+        batch_extractor::m_values[column].push_back(batch_extractor::m_row_values[column]);
+        batch_extractor::m_valid[column].push_back(batch_extractor::m_row_valid[column]);
+    }
+}
+const std::vector<field_handle_t>& batch_extractor::get_handles()
+{
+    // Consecutive messages usually have the same type, which is still current if one of its handles is.
+    const resolution_t* current = batch_extractor::m_current_resolution;
+    if(current != nullptr && current->probe < current->handles.size() && !batch_extractor::m_introspector.is_stale(current->handles[current->probe]))
+    {
+        return current->handles;
+    }
+
+    // Otherwise find the resolution of the introspector's message type.
+    std::shared_ptr<const schema_t> schema = batch_extractor::m_introspector.schema();
+    if(schema == nullptr)
+    {
+        return batch_extractor::m_unresolved;
+    }
+    auto entry = batch_extractor::m_resolutions.find(schema->id());
+    if(entry == batch_extractor::m_resolutions.end())
+    {
+        // Resolve each path, leaving the handles of paths that do not exist in the type unresolved, so reading them fails.
+        resolution_t resolution;
+        resolution.handles.resize(batch_extractor::m_paths.size());
+        resolution.probe = static_cast<uint32_t>(batch_extractor::m_paths.size());
+        for(uint32_t column = 0; column < batch_extractor::m_paths.size(); ++column)
+        {
+            if(batch_extractor::m_introspector.get_handle(batch_extractor::m_paths[column], resolution.handles[column]) && resolution.probe == batch_extractor::m_paths.size())
+            {
+                resolution.probe = column;
+            }
+        }
+        entry = batch_extractor::m_resolutions.emplace(schema->id(), std::move(resolution)).first;
+    }
+
+    // Remember the type for the next message.
+    batch_extractor::m_current_resolution = &(entry->second);
+
+    return entry->second.handles;
+}
+
+// COLUMNS
+uint32_t batch_extractor::n_columns() const
+{
+    return static_cast<uint32_t>(batch_extractor::m_paths.size());
+}
+size_t batch_extractor::n_rows() const
+{
+    return batch_extractor::m_stamps.size();
+}
+const std::string& batch_extractor::path(uint32_t column) const
+{
+    return batch_extractor::m_paths.at(column);
+}
+const std::vector<ros::Time>& batch_extractor::stamps() const
+{
+    return batch_extractor::m_stamps;
+}
+const std::vector<double>& batch_extractor::values(uint32_t column) const
+{
+    return batch_extractor::m_values.at(column);
+}
+const std::vector<uint8_t>& batch_extractor::valid(uint32_t column) const
+{
+    return batch_extractor::m_valid.at(column);
+}
+
+// STORAGE
+void batch_extractor::reserve(size_t n_rows)
+{
+    batch_extractor::m_stamps.reserve(n_rows);
+    for(uint32_t column = 0; column < batch_extractor::m_paths.size(); ++column)
+    {
+        batch_extractor::m_values[column].reserve(n_rows);
+        batch_extractor::m_valid[column].reserve(n_rows);
+    }
+}
+void batch_extractor::clear()
+{
+    batch_extractor::m_stamps.clear();
+    for(uint32_t column = 0; column < batch_extractor::m_paths.size(); ++column)
+    {
+        batch_extractor::m_values[column].clear();
+        batch_extractor::m_valid[column].clear();
+    }
+}
\ No newline at end of file
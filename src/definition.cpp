@@ -8,6 +8,8 @@ definition_t::definition_t()
     definition_t::m_type = "";
     definition_t::m_primitive_type = definition_t::primitive_type_t::NON_PRIMITIVE;
     definition_t::m_size = 0;
+    definition_t::m_fixed_size = false;
+    definition_t::m_serialized_size = 0;
     definition_t::m_array = "";
     definition_t::m_array_type = definition_t::array_type_t::NONE;
     definition_t::m_array_length = 0;
@@ -50,7 +52,7 @@ definition_t::definition_t(const std::string& type, const std::string& array, co
 }
 
 // TYPE
-std::string definition_t::type() const
+const std::string& definition_t::type() const
 {
     return definition_t::m_type;
 }
@@ -66,9 +68,17 @@ uint32_t definition_t::size() const
 {
     return definition_t::m_size;
 }
+bool definition_t::is_fixed_size() const
+{
+    return definition_t::m_fixed_size;
+}
+uint32_t definition_t::serialized_size() const
+{
+    return definition_t::m_serialized_size;
+}
 
 // ARRAY
-std::string definition_t::array() const
+const std::string& definition_t::array() const
 {
     return definition_t::m_array;
 }
@@ -86,13 +96,13 @@ uint32_t definition_t::array_length() const
 }
 
 // NAME
-std::string definition_t::name() const
+const std::string& definition_t::name() const
 {
     return definition_t::m_name;
 }
 
 // PATH
-std::string definition_t::path() const
+const std::string& definition_t::path() const
 {
     return definition_t::m_path;
 }
@@ -178,12 +188,22 @@ void definition_t::update_type(const std::string& type)
         definition_t::m_primitive_type = definition_t::primitive_type_t::NON_PRIMITIVE;
         definition_t::m_size = 0;
     }
+
+    // Only strings vary in size between primitive instances.
+    // Non-primitive types are updated once their fields are known.
+    definition_t::m_fixed_size = definition_t::is_primitive() && definition_t::m_primitive_type != definition_t::primitive_type_t::STRING;
+    definition_t::m_serialized_size = definition_t::m_size;
 }
 void definition_t::update_size(uint32_t size)
 {
     // Update the size.
     definition_t::m_size = size;
 }
+void definition_t::update_serialized_size(bool fixed_size, uint32_t serialized_size)
+{
+    definition_t::m_fixed_size = fixed_size;
+    definition_t::m_serialized_size = serialized_size;
+}
 void definition_t::update_array_length(uint32_t length)
 {
     definition_t::m_array_length = length;
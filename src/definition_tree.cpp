@@ -1,99 +1,139 @@
 #include "message_introspection/definition_tree.h"
 
-#include <boost/tokenizer.hpp>
+#include <algorithm>
+#include <limits>
 
 using namespace message_introspection;
 
-// PATH
-std::vector<std::string> definition_tree_t::tokenize_path(const std::string& path) const
+// CONSTRUCTORS
+definition_tree_t::definition_tree_t()
 {
-    // Set up tokenizer.
-    boost::char_separator<char> delimiter(".");
-    boost::tokenizer<boost::char_separator<char>> tokenizer(path, delimiter);
+    definition_tree_t::m_n_indexed = 0;
+}
 
-    // Create output vector.
-    std::vector<std::string> output;
+// INDEX
+const uint32_t definition_tree_t::s_empty_entry = std::numeric_limits<uint32_t>::max();
+void definition_tree_t::index_fields()
+{
+    // Size the table to a power of two at least twice the number of fields, which keeps probe sequences short.
+    size_t table_size = 1;
+    while(table_size < definition_tree_t::fields.size() * 2)
+    {
+        table_size *= 2;
+    }
+    definition_tree_t::m_field_index.assign(definition_tree_t::fields.empty() ? 0 : table_size, definition_tree_t::s_empty_entry);
 
-    // Iterate through tokens to populate output while removing array indicators.
-    for(auto token = tokenizer.begin(); token != tokenizer.end(); ++ token)
+    // Insert each field, keeping only the first of any fields with the same name.
+    uint32_t mask = static_cast<uint32_t>(table_size - 1);
+    for(uint32_t field = 0; field < definition_tree_t::fields.size(); ++field)
     {
-        std::string path_part = *token;
-        auto array_indicator = path_part.find_first_of('[');
-        if(array_indicator != std::string::npos)
+        const std::string& name = definition_tree_t::fields[field].definition.name();
+        uint32_t entry = definition_tree_t::hash_name(name.data(), name.data() + name.size()) & mask;
+        for(; definition_tree_t::m_field_index[entry] != definition_tree_t::s_empty_entry; entry = (entry + 1) & mask)
+        {
+            if(definition_tree_t::fields[definition_tree_t::m_field_index[entry]].definition.name() == name)
+            {
+                break;
+            }
+        }
+        if(definition_tree_t::m_field_index[entry] == definition_tree_t::s_empty_entry)
         {
-            path_part.erase(array_indicator);
+            definition_tree_t::m_field_index[entry] = field;
         }
-        output.push_back(path_part);
     }
-    
-    return output;
+    definition_tree_t::m_n_indexed = definition_tree_t::fields.size();
+
+    // Index the fields' own fields.
+    for(auto field = definition_tree_t::fields.begin(); field != definition_tree_t::fields.end(); ++field)
+    {
+        field->index_fields();
+    }
 }
-bool definition_tree_t::path_exists(const std::string& path) const
+uint32_t definition_tree_t::hash_name(const char* begin, const char* end)
 {
-    // Get the path components.
-    // NOTE: the tokenize function already removes array indicators.
-    auto path_parts = definition_tree_t::tokenize_path(path);
+    // FNV-1a hash.
+    uint32_t hash = 2166136261u;
+    for(const char* character = begin; character != end; ++character)
+    {
+        hash = (hash ^ static_cast<uint8_t>(*character)) * 16777619u;
+    }
+    return hash;
+}
+const definition_tree_t* definition_tree_t::find_field(const char* begin, const char* end) const
+{
+    size_t length = end - begin;
 
-    // Iterate through the tree.
-    const definition_tree_t* current_tree = this;
-    for(auto path_part = path_parts.cbegin(); path_part != path_parts.cend(); ++path_part)
+    // Use the index if it is up to date.
+    if(!definition_tree_t::m_field_index.empty() && definition_tree_t::m_n_indexed == definition_tree_t::fields.size())
     {
-        bool path_part_found = false;
-        // Iterate through the tree's fields.
-        for(auto field = current_tree->fields.cbegin(); field != current_tree->fields.cend(); ++field)
+        uint32_t mask = static_cast<uint32_t>(definition_tree_t::m_field_index.size() - 1);
+        for(uint32_t entry = definition_tree_t::hash_name(begin, end) & mask; definition_tree_t::m_field_index[entry] != definition_tree_t::s_empty_entry; entry = (entry + 1) & mask)
         {
-            // Check if field matches the path part.
-            if(field->definition.name().compare(*path_part) == 0)
+            const definition_tree_t& field = definition_tree_t::fields[definition_tree_t::m_field_index[entry]];
+            if(field.definition.name().compare(0, std::string::npos, begin, length) == 0)
             {
-                // Path part exists.
-                path_part_found = true;
-                current_tree = &(*field);
-                break;
+                return &field;
             }
         }
-        // Check if path_part was found in any of the fields.
-        if(!path_part_found)
+        // Fields that were renamed, reordered or replaced since indexing are missing from the index,
+        // so a miss is confirmed by searching the fields.
+    }
+
+    // Otherwise search the fields in order.
+    for(auto field = definition_tree_t::fields.cbegin(); field != definition_tree_t::fields.cend(); ++field)
+    {
+        if(field->definition.name().compare(0, std::string::npos, begin, length) == 0)
         {
-            return false;
+            return &(*field);
         }
     }
+    return nullptr;
+}
+
+// PATH
+bool definition_tree_t::next_part(const char*& position, const char* end, const char*& part_begin, const char*& part_end)
+{
+    // Skip any separators before the component.
+    while(position != end && *position == '.')
+    {
+        ++position;
+    }
+    if(position == end)
+    {
+        return false;
+    }
+
+    // The component runs to the next separator, and its name stops at any array indicator.
+    part_begin = position;
+    position = std::find(position, end, '.');
+    part_end = std::find(part_begin, position, '[');
 
-    // If this point reached, all path parts exist.
     return true;
 }
+bool definition_tree_t::path_exists(const std::string& path) const
+{
+    return definition_tree_t::get_path_tree(path) != nullptr;
+}
 bool definition_tree_t::path_has_arrays(const std::string& path) const
 {
-    // Get the path components.
-    // NOTE: the tokenize function already removes array indicators.
-    auto path_parts = definition_tree_t::tokenize_path(path);
-
     // Iterate through the tree.
+    const char* position = path.data();
+    const char* end = position + path.size();
+    const char* part_begin;
+    const char* part_end;
     const definition_tree_t* current_tree = this;
-    for(auto path_part = path_parts.cbegin(); path_part != path_parts.cend(); ++path_part)
+    while(definition_tree_t::next_part(position, end, part_begin, part_end))
     {
-        bool path_part_found = false;
-        // Iterate through the tree's fields.
-        for(auto field = current_tree->fields.cbegin(); field != current_tree->fields.cend(); ++field)
+        current_tree = current_tree->find_field(part_begin, part_end);
+        // Check if the path part exists.
+        if(current_tree == nullptr)
         {
-            // Check if field matches the path part.
-            if(field->definition.name().compare(*path_part) == 0)
-            {
-                // Path part exists.
-                // Check if the field is an array.
-                if(field->definition.is_array())
-                {
-                    return true;
-                }
-                // Otherise, continue searching through tree.
-                path_part_found = true;
-                current_tree = &(*field);
-                break;
-            }
+            return false;
         }
-        // Check if path_part was found in any of the fields.
-        if(!path_part_found)
+        // Check if the field is an array.
+        if(current_tree->definition.is_array())
         {
-            return false;
+            return true;
         }
     }
 
@@ -102,79 +142,65 @@ bool definition_tree_t::path_has_arrays(const std::string& path) const
 }
 bool definition_tree_t::get_path_definition(const std::string& path, definition_t& definition) const
 {
-    // Get the path components.
-    // NOTE: the tokenize function already removes array indicators.
-    auto path_parts = definition_tree_t::tokenize_path(path);
+    // Find the sub tree for the path.
+    const definition_tree_t* path_tree = definition_tree_t::get_path_tree(path);
+    if(path_tree == nullptr)
+    {
+        definition = definition_t();
+        return false;
+    }
 
-    // Iterate through the path to get the final definition.
-    const definition_tree_t* current_tree = this;
-    for(auto path_part = path_parts.cbegin(); path_part != path_parts.cend(); ++path_part)
+    // An empty path leaves the definition unchanged.
+    if(path_tree != this)
     {
-        // Iterate through fields to find the matching path part.
-        bool path_part_found = false;
-        for(auto field = current_tree->fields.cbegin(); field != current_tree->fields.cend(); ++field)
-        {
-            if(field->definition.name().compare(*path_part) == 0)
-            {
-                // Path part found.
-                // Store this definition as the output (last path part goes out)
-                definition = field->definition;
-                // Indicate that path part was found.
-                path_part_found = true;
-                // Update the current_tree to this field.
-                current_tree = &(*field);
-                // Stop the search in this tree's children.
-                break;
-            }
-        }
-        // Check if path part was found.
-        if(!path_part_found)
-        {
-            definition = definition_t();
-            return false;
-        }
+        definition = path_tree->definition;
     }
 
     return true;
 }
 bool definition_tree_t::get_path_definitions(const std::string& path, std::vector<definition_t>& definitions) const
 {
-    // Get the path components.
-    // NOTE: the tokenize function already removes array indicators.
-    auto path_parts = definition_tree_t::tokenize_path(path);
-
     // Iterate through the path parts to build the definitions.
+    const char* position = path.data();
+    const char* end = position + path.size();
+    const char* part_begin;
+    const char* part_end;
     const definition_tree_t* current_tree = this;
-    for(auto path_part = path_parts.cbegin(); path_part != path_parts.cend(); ++path_part)
+    while(definition_tree_t::next_part(position, end, part_begin, part_end))
     {
-        // Find the matching field by name and grab it's definition.
-        bool definition_found = false;
-        for(auto field = current_tree->fields.cbegin(); field != current_tree->fields.cend(); ++field)
-        {
-            if(field->definition.name().compare(*path_part) == 0)
-            {
-                // Definition found.
-                // Add the definition to the output.
-                definitions.push_back(field->definition);
-                // Flag that it was found.
-                definition_found = true;
-                // Update the current_tree to this field.
-                current_tree = &(*field);
-                // Stop the search in this tree's children.
-                break;
-            }
-        }
-
+        current_tree = current_tree->find_field(part_begin, part_end);
         // Check if definition was not found.
-        if(!definition_found)
+        if(current_tree == nullptr)
         {
             definitions.clear();
             return false;
         }
+        // Add the definition to the output.
+        definitions.push_back(current_tree->definition);
     }
 
     return true;
 }
+const definition_tree_t* definition_tree_t::get_path_tree(const std::string& path) const
+{
+    // Iterate through the tree.
+    const char* position = path.data();
+    const char* end = position + path.size();
+    const char* part_begin;
+    const char* part_end;
+    const definition_tree_t* current_tree = this;
+    while(definition_tree_t::next_part(position, end, part_begin, part_end))
+    {
+        current_tree = current_tree->find_field(part_begin, part_end);
+        // Check if path_part was found in any of the fields.
+        if(current_tree == nullptr)
+        {
+            return nullptr;
+        }
+    }
+
+    return current_tree;
+}
 
 // PRINT
 std::string definition_tree_t::print() const
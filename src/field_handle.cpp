@@ -0,0 +1,28 @@
+#include "message_introspection/field_handle.h"
+
+using namespace message_introspection;
+
+// CONSTRUCTORS
+field_handle_t::field_handle_t()
+{
+    field_handle_t::m_schema = 0;
+    field_handle_t::m_owner = 0;
+    field_handle_t::m_slot = 0;
+    field_handle_t::m_generation = 0;
+    field_handle_t::m_path = "";
+    field_handle_t::m_primitive_type = definition_t::primitive_type_t::NON_PRIMITIVE;
+}
+
+// PROPERTIES
+bool field_handle_t::is_resolved() const
+{
+    return field_handle_t::m_schema != 0;
+}
+std::string field_handle_t::path() const
+{
+    return field_handle_t::m_path;
+}
+definition_t::primitive_type_t field_handle_t::primitive_type() const
+{
+    return field_handle_t::m_primitive_type;
+}
\ No newline at end of file
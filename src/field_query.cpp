@@ -0,0 +1,25 @@
+#include "message_introspection/field_query.h"
+
+using namespace message_introspection;
+
+// CONSTRUCTORS
+field_query_t::field_query_t()
+{
+    field_query_t::m_schema = 0;
+    field_query_t::m_path = "";
+    field_query_t::m_primitive_type = definition_t::primitive_type_t::NON_PRIMITIVE;
+}
+
+// PROPERTIES
+bool field_query_t::is_resolved() const
+{
+    return field_query_t::m_schema != 0;
+}
+std::string field_query_t::path() const
+{
+    return field_query_t::m_path;
+}
+definition_t::primitive_type_t field_query_t::primitive_type() const
+{
+    return field_query_t::m_primitive_type;
+}
\ No newline at end of file
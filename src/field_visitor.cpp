@@ -0,0 +1,34 @@
+#include "message_introspection/field_visitor.h"
+
+using namespace message_introspection;
+
+// CONSTRUCTORS
+field_visitor::~field_visitor()
+{
+}
+
+// FIELDS
+void field_visitor::on_primitive_array(const schema_t::node_t& definition, uint32_t node, const uint8_t* data, uint32_t count)
+{
+    // Pass each element individually.
+    uint32_t size = definition.serialized_size;
+    for(uint32_t index = 0; index < count; ++index)
+    {
+        this->on_field(definition, node, index, data + static_cast<size_t>(index) * size, size);
+    }
+}
+
+// STRUCTURE
+// Visitors only override the structure events that they need.
+void field_visitor::on_message_begin(const schema_t::node_t&, uint32_t, uint32_t)
+{
+}
+void field_visitor::on_message_end(const schema_t::node_t&, uint32_t)
+{
+}
+void field_visitor::on_array_begin(const schema_t::node_t&, uint32_t, uint32_t)
+{
+}
+void field_visitor::on_array_end(const schema_t::node_t&, uint32_t)
+{
+}
\ No newline at end of file
@@ -1,19 +1,138 @@
 #include "message_introspection/introspector.h"
 
-#include <boost/tokenizer.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
 
 using namespace message_introspection;
 
+// INTROSPECTOR IDS
+/// \brief Stores the last ID assigned to any introspector.
+static std::atomic<uint64_t> s_last_id(0);
+
+// NUMBER CONVERSION
+/// \brief Converts a serialized fixed size primitive to a double.
+/// \tparam T The C++ type of the primitive.
+/// \param bytes The primitive's serialized bytes.
+/// \returns The primitive's value as a double.
+template<typename T>
+static double convert_number(const uint8_t* bytes)
+{
+    // Using endian.h automatically assumes host is little endian. No need for conversion.
+    return static_cast<double>(*reinterpret_cast<const T*>(bytes));
+}
+/// \brief Converts a serialized time or duration to seconds.
+/// \param bytes The time's serialized bytes.
+/// \returns The time in seconds.
+static double convert_seconds(const uint8_t* bytes)
+{
+    uint32_t sec = *reinterpret_cast<const uint32_t*>(bytes);
+    uint32_t nsec = *reinterpret_cast<const uint32_t*>(bytes + 4);
+    return static_cast<double>(sec) + static_cast<double>(nsec) / 1000000000.0;
+}
+/// \brief A function that converts a serialized primitive to a double.
+typedef double (*number_converter_t)(const uint8_t* bytes);
+/// \brief The number converter of each primitive type, indexed by primitive type.
+/// \details Strings are parsed rather than converted, and non-primitives can't be read as numbers, so they have no converter.
+static constexpr number_converter_t s_number_converters[] =
+{
+    nullptr,
+    &convert_number<bool>,
+    &convert_number<int8_t>,
+    &convert_number<int16_t>,
+    &convert_number<int32_t>,
+    &convert_number<int64_t>,
+    &convert_number<uint8_t>,
+    &convert_number<uint16_t>,
+    &convert_number<uint32_t>,
+    &convert_number<uint64_t>,
+    &convert_number<float>,
+    &convert_number<double>,
+    nullptr,
+    &convert_seconds,
+    &convert_seconds
+};
+static_assert(sizeof(s_number_converters) / sizeof(number_converter_t) == static_cast<size_t>(definition_t::primitive_type_t::DURATION) + 1, "Every primitive type needs a number converter entry.");
+
+// QUERY PARSING
+/// \brief Parses an array index in a query path.
+/// \param path The query path.
+/// \param begin The position of the index's first digit.
+/// \param end The position after the index's last digit.
+/// \param index The parsed index.
+/// \returns TRUE if the index is a complete unsigned number, otherwise FALSE.
+/// \details The largest uint32 value is reserved for the open end of a range.
+static bool parse_index(const std::string& path, size_t begin, size_t end, uint32_t& index)
+{
+    if(begin == end)
+    {
+        return false;
+    }
+    uint64_t value = 0;
+    for(size_t c = begin; c < end; ++c)
+    {
+        if(path[c] < '0' || path[c] > '9')
+        {
+            return false;
+        }
+        value = value * 10 + static_cast<uint64_t>(path[c] - '0');
+        if(value >= std::numeric_limits<uint32_t>::max())
+        {
+            return false;
+        }
+    }
+    index = static_cast<uint32_t>(value);
+    return true;
+}
+
 // CONSTRUCTORS
 introspector::introspector()
 {
+    // Assign a unique ID, which identifies the position cache of resolved handles.
+    introspector::m_id = ++s_last_id;
+
+    // Initialize the schema cache.
+    introspector::m_schema = nullptr;
+    introspector::m_schema_capacity = 8;
+
     // Initialize serialized bytes.
+    introspector::m_buffer = nullptr;
+    introspector::m_capacity = 0;
+    introspector::m_buffer_limit = 0;
     introspector::m_bytes = nullptr;
+    introspector::m_length = 0;
+    introspector::m_message = 0;
+
+    // Initialize the field index.
+    introspector::m_indexed = 0;
+    introspector::m_indexed_fields = 0;
+    introspector::m_shape_schema = 0;
+    introspector::m_shape_length = 0;
+    introspector::m_layout = 0;
+
+    // Index messages when they arrive by default.
+    introspector::m_lazy = false;
+
+    // Initialize statistics.
+    introspector::m_timing_interval = 64;
+    introspector::reset_stats();
+
+    // No lookups have been made yet.
+    introspector::m_status = status_t::OK;
+}
+introspector::introspector(const std::shared_ptr<const schema_t>& schema)
+    : introspector()
+{
+    // Start with the schema registered.
+    introspector::add_schema(schema);
 }
 introspector::~introspector()
 {
     // Clean up message bytes.
-    delete [] introspector::m_bytes;
+    delete [] introspector::m_buffer;
 }
 
 // CONFIG
@@ -27,568 +146,1954 @@ void introspector::new_message_type(const std::string& type, const std::string&
     }
 
     // Clear old data.
-    delete [] introspector::m_bytes;
+    // The buffer and field map are kept for reuse by the next message.
     introspector::m_bytes = nullptr;
-
-    // Update field map.
-    introspector::m_field_map.clear();
+    introspector::m_length = 0;
+    ++introspector::m_message;
 }
-
-// MESSAGE
-void introspector::new_message(const topic_tools::ShapeShifter& message)
+void introspector::set_lazy(bool lazy)
 {
-    // First register the message if it hasn't been registered already.
-    if(!introspector::is_registered(message.getMD5Sum()))
-    {
-        // Register message.
-        introspector::register_message(message.getMD5Sum(), message.getDataType(), message.getMessageDefinition());
-    }
-
-    // Clear old data.
-    delete [] introspector::m_bytes;
-
-    // Get serialized length and set up bytes for capture.
-    uint32_t message_length = ros::serialization::serializationLength(message);
-    introspector::m_bytes = new uint8_t[message_length];
-
-    // Serialize data into byte storage.
-    ros::serialization::OStream stream(introspector::m_bytes, message_length);
-    ros::serialization::serialize(stream, message);
-
-    // Update field map.
-    introspector::m_field_map.clear();
-    std::string current_path = "";
-    uint32_t current_position = 0;
-    introspector::update_field_map(introspector::m_definition_tree, current_path, current_position);
+    introspector::m_lazy = lazy;
 }
-void introspector::new_message(const rosbag::MessageInstance& message)
+bool introspector::is_lazy() const
 {
-    // First register the message if it hasn't been registered already.
-    if(!introspector::is_registered(message.getMD5Sum()))
-    {
-        // Register message.
-        introspector::register_message(message.getMD5Sum(), message.getDataType(), message.getMessageDefinition());
-    }
-
-    // Clear old data.
-    delete [] introspector::m_bytes;
-
-    // Copy serialized bytes to this instance.
-    introspector::m_bytes = new uint8_t[message.size()];
-    ros::serialization::OStream stream(introspector::m_bytes, message.size());
-    message.write(stream);
-
-    // Update field map.
-    introspector::m_field_map.clear();
-    std::string current_path = "";
-    uint32_t current_position = 0;
-    introspector::update_field_map(introspector::m_definition_tree, current_path, current_position);
+    return introspector::m_lazy;
 }
-void introspector::register_message(const std::string& md5, const std::string& type, const std::string& definition)
+void introspector::set_interest(const std::vector<std::string>& paths)
 {
-    // Extract message component types.
-    introspector::parse_components(type, definition);
-
-    // Add top level message to the definition, and let recursion handle the rest.
-    introspector::m_definition_tree = definition_tree_t();
-    introspector::add_definition("", introspector::m_definition_tree, definition_t(type, "", ""));
+    introspector::m_interest = paths;
 
-    // Store MD5.
-    introspector::m_md5 = md5;
-}
-bool introspector::is_registered(const std::string& md5)
-{
-    return (introspector::m_md5.compare(md5) == 0);
-}
+    // Find the fields of interest in every cached schema.
+    for(auto entry = introspector::m_schemas.begin(); entry != introspector::m_schemas.end(); ++entry)
+    {
+        introspector::update_interest(*entry);
+    }
 
-// GET
-bool introspector::path_exists(const std::string& path) const
-{
-    return introspector::m_field_map.count(path);
-}
-bool introspector::get_bool(const std::string& path, bool& value) const
-{
-    return introspector::get_field<bool>(path, definition_t::primitive_type_t::BOOL, value);
+    // The current message's index may not cover the new interest set, so it is indexed again on its next read.
+    introspector::m_indexed = 0;
 }
-bool introspector::get_int8(const std::string& path, int8_t& value) const
+const std::vector<std::string>& introspector::interest() const
 {
-    return introspector::get_field<int8_t>(path, definition_t::primitive_type_t::INT8, value);
+    return introspector::m_interest;
 }
-bool introspector::get_int16(const std::string& path, int16_t& value) const
+void introspector::set_schema_capacity(uint32_t capacity)
 {
-    return introspector::get_field<int16_t>(path, definition_t::primitive_type_t::INT16, value);
+    // At least the current schema must be kept.
+    introspector::m_schema_capacity = std::max<uint32_t>(capacity, 1);
+
+    // Evict any schemas beyond the new capacity.
+    introspector::trim_schemas();
 }
-bool introspector::get_int32(const std::string& path, int32_t& value) const
+uint32_t introspector::schema_capacity() const
 {
-    return introspector::get_field<int32_t>(path, definition_t::primitive_type_t::INT32, value);
+    return introspector::m_schema_capacity;
 }
-bool introspector::get_int64(const std::string& path, int64_t& value) const
+void introspector::set_buffer_limit(uint32_t limit)
 {
-    return introspector::get_field<int64_t>(path, definition_t::primitive_type_t::INT64, value);
+    introspector::m_buffer_limit = limit;
 }
-bool introspector::get_uint8(const std::string& path, uint8_t& value) const
+uint32_t introspector::buffer_limit() const
 {
-    return introspector::get_field<uint8_t>(path, definition_t::primitive_type_t::UINT8, value);
+    return introspector::m_buffer_limit;
 }
-bool introspector::get_uint16(const std::string& path, uint16_t& value) const
+
+// STATISTICS
+introspector::stats_t introspector::stats() const
 {
-    return introspector::get_field<uint16_t>(path, definition_t::primitive_type_t::UINT16, value);
+    stats_t stats = introspector::m_stats;
+
+    // Take a snapshot of the field index.
+    stats.n_index_entries = introspector::m_anchors.size() + introspector::m_frames.size();
+
+    // Estimate the memory of the field index, the handle position cache, and the resolved paths.
+    stats.index_memory = introspector::m_anchors.capacity() * sizeof(anchor_t)
+                       + introspector::m_frames.capacity() * sizeof(frame_t)
+                       + introspector::m_shape.capacity() * sizeof(shape_entry_t)
+                       + introspector::m_handle_cache.capacity() * sizeof(handle_cache_t)
+                       + introspector::m_free_slots.capacity() * sizeof(uint32_t)
+                       + introspector::m_route.capacity() * sizeof(field_handle_t::step_t)
+                       + introspector::m_indices.capacity() * sizeof(uint32_t)
+                       + introspector::m_pattern.capacity();
+    for(auto entry = introspector::m_schemas.cbegin(); entry != introspector::m_schemas.cend(); ++entry)
+    {
+        for(auto pattern = entry->patterns.cbegin(); pattern != entry->patterns.cend(); ++pattern)
+        {
+            stats.index_memory += sizeof(*pattern) + pattern->first.capacity() + pattern->second.parts.capacity() * sizeof(schema_t::pattern_t::part_t);
+        }
+        for(auto slot = entry->slots.cbegin(); slot != entry->slots.cend(); ++slot)
+        {
+            stats.index_memory += sizeof(*slot) + slot->first.capacity();
+        }
+    }
+
+    stats.buffer_capacity = introspector::m_capacity;
+
+    return stats;
 }
-bool introspector::get_uint32(const std::string& path, uint32_t& value) const
+void introspector::reset_stats()
 {
-    return introspector::get_field<uint32_t>(path, definition_t::primitive_type_t::UINT32, value);
+    introspector::m_stats = stats_t();
+    introspector::m_timing_countdown = (introspector::m_timing_interval != 0) ? introspector::m_timing_interval : std::numeric_limits<uint32_t>::max();
 }
-bool introspector::get_uint64(const std::string& path, uint64_t& value) const
+void introspector::set_timing_interval(uint32_t interval)
 {
-    return introspector::get_field<uint64_t>(path, definition_t::primitive_type_t::UINT64, value);
+    introspector::m_timing_interval = interval;
+    introspector::m_timing_countdown = (interval != 0) ? interval : std::numeric_limits<uint32_t>::max();
 }
-bool introspector::get_float32(const std::string& path, float& value) const
+uint32_t introspector::timing_interval() const
 {
-    return introspector::get_field<float_t>(path, definition_t::primitive_type_t::FLOAT32, value);
+    return introspector::m_timing_interval;
 }
-bool introspector::get_float64(const std::string& path, double& value) const
+std::chrono::steady_clock::time_point introspector::start_timing(timing_t& timing) const
 {
-    return introspector::get_field<double_t>(path, definition_t::primitive_type_t::FLOAT64, value);
+    // Only time every n-th call, since reading the clock costs more than many of the operations.
+    ++timing.n_calls;
+    if(--introspector::m_timing_countdown != 0)
+    {
+        return std::chrono::steady_clock::time_point();
+    }
+
+    // Restart the countdown, which never reaches zero again if timing is disabled.
+    if(introspector::m_timing_interval == 0)
+    {
+        introspector::m_timing_countdown = std::numeric_limits<uint32_t>::max();
+        return std::chrono::steady_clock::time_point();
+    }
+    introspector::m_timing_countdown = introspector::m_timing_interval;
+    return std::chrono::steady_clock::now();
 }
-bool introspector::get_string(const std::string& path, std::string& value) const
+void introspector::stop_timing(timing_t& timing, std::chrono::steady_clock::time_point start) const
 {
-    try
+    // Skip calls that were not timed.
+    if(start == std::chrono::steady_clock::time_point())
     {
-        // Get field info from map.
-        auto field_info = introspector::m_field_map.at(path);
-
-        // Check field type.
-        if(field_info.primitive_type != definition_t::primitive_type_t::STRING)
-        {
-            return false;
-        }
+        return;
+    }
 
-        // Read the strings length.
-        uint32_t string_length = introspector::read_value<uint32_t>(field_info.position);
+    std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+    ++timing.n_timed;
+    timing.total_time += elapsed;
 
-        // Read the string.
-        value = std::string(reinterpret_cast<char*>(&(introspector::m_bytes[field_info.position + 4])), string_length);
+    // Find the call's histogram bucket, which is the floor of its duration's base 2 logarithm.
+    uint64_t nanoseconds = static_cast<uint64_t>(std::max<int64_t>(elapsed.count(), 0));
+    uint32_t bucket = 0;
+    while(nanoseconds > 1 && bucket + 1 < timing.histogram.size())
+    {
+        nanoseconds >>= 1;
+        ++bucket;
     }
-    catch(...)
+    ++timing.histogram[bucket];
+}
+bool introspector::end_lookup(std::chrono::steady_clock::time_point start, status_t status) const
+{
+    introspector::stop_timing(introspector::m_stats.lookups, start);
+    introspector::m_status = status;
+    if(status != status_t::OK)
     {
+        ++introspector::m_stats.n_failed_lookups;
         return false;
     }
-
     return true;
 }
-bool introspector::get_time(const std::string& path, ros::Time& value) const
+
+// MESSAGE
+void introspector::new_message(const topic_tools::ShapeShifter& message)
 {
-    try
+    auto start = introspector::start_timing(introspector::m_stats.messages);
+
+    // First register the message if it hasn't been registered already.
+    if(!introspector::is_registered(message.getMD5Sum()))
     {
-        // Get field info from map.
-        auto field_info = introspector::m_field_map.at(path);
+        // Register message.
+        introspector::register_message(message.getMD5Sum(), message.getDataType(), message.getMessageDefinition());
+    }
 
-        // Check field type.
-        if(field_info.primitive_type != definition_t::primitive_type_t::TIME)
-        {
-            return false;
-        }
+    // Get serialized length and set up bytes for capture.
+    // NOTE: ShapeShifter does not expose its internal buffer, so the message must be serialized into our own.
+    uint32_t message_length = ros::serialization::serializationLength(message);
+    uint8_t* bytes = introspector::allocate_bytes(message_length);
 
-        // Extract secs and nsecs.
-        value.sec = introspector::read_value<uint32_t>(field_info.position);
-        value.nsec = introspector::read_value<uint32_t>(field_info.position + 4);
-    }
-    catch(...)
+    // Serialize data into byte storage.
+    ros::serialization::OStream stream(bytes, message_length);
+    ros::serialization::serialize(stream, message);
+
+    // Parse the new message.
+    introspector::parse_message();
+
+    introspector::stop_timing(introspector::m_stats.messages, start);
+}
+void introspector::new_message(const rosbag::MessageInstance& message)
+{
+    auto start = introspector::start_timing(introspector::m_stats.messages);
+
+    // First register the message if it hasn't been registered already.
+    if(!introspector::is_registered(message.getMD5Sum()))
     {
-        return false;
+        // Register message.
+        introspector::register_message(message.getMD5Sum(), message.getDataType(), message.getMessageDefinition());
     }
 
-    return true;
+    // Copy serialized bytes to this instance.
+    uint8_t* bytes = introspector::allocate_bytes(message.size());
+    ros::serialization::OStream stream(bytes, message.size());
+    message.write(stream);
+
+    // Parse the new message.
+    introspector::parse_message();
+
+    introspector::stop_timing(introspector::m_stats.messages, start);
 }
-bool introspector::get_duration(const std::string& path, ros::Duration& value) const
+bool introspector::new_message(const uint8_t* data, size_t length, const std::string& md5, const std::string& type, const std::string& definition, bool borrow)
 {
-    try
+    auto start = introspector::start_timing(introspector::m_stats.messages);
+
+    // First register the message if it hasn't been registered already.
+    if(!introspector::is_registered(md5))
     {
-        // Get field info from map.
-        auto field_info = introspector::m_field_map.at(path);
+        // Register message.
+        introspector::register_message(md5, type, definition);
+    }
 
-        // Check field type.
-        if(field_info.primitive_type != definition_t::primitive_type_t::DURATION)
-        {
-            return false;
-        }
+    // Positions within a message are 32 bit, so larger messages are rejected rather than truncated.
+    if(length > std::numeric_limits<uint32_t>::max())
+    {
+        introspector::m_bytes = nullptr;
+        introspector::m_length = 0;
+        ++introspector::m_message;
+        introspector::m_status = status_t::TOO_LARGE;
+        introspector::stop_timing(introspector::m_stats.messages, start);
+        return false;
+    }
 
-        // Extract secs and nsecs.
-        value.sec = introspector::read_value<uint32_t>(field_info.position);
-        value.nsec = introspector::read_value<uint32_t>(field_info.position + 4);
+    // Either read directly from the caller's memory, or copy it to this instance.
+    if(borrow)
+    {
+        introspector::borrow_bytes(data, static_cast<uint32_t>(length));
     }
-    catch(...)
+    else
     {
-        return false;
+        uint8_t* bytes = introspector::allocate_bytes(static_cast<uint32_t>(length));
+        std::memcpy(bytes, data, length);
     }
 
+    // Parse the new message.
+    introspector::parse_message();
+
+    introspector::stop_timing(introspector::m_stats.messages, start);
     return true;
 }
-bool introspector::get_number(const std::string& path, double& value) const
+uint8_t* introspector::allocate_bytes(uint32_t length)
 {
-    try
+    // Every caller copies the message's serialized bytes into the storage.
+    introspector::m_stats.bytes_copied += length;
+
+    // Release storage grown by an outlier once a message arrives that fits within the limit.
+    if(introspector::m_buffer_limit != 0 && introspector::m_capacity > introspector::m_buffer_limit && length <= introspector::m_buffer_limit)
     {
-        // Get field info from map.
-        auto field_info = introspector::m_field_map.at(path);
+        introspector::release_bytes();
+    }
 
-        // Use the appropriate get function to grab the value and convert it to a double.
-        switch(field_info.primitive_type)
-        {
-            case definition_t::primitive_type_t::BOOL:
-            {
-                value = static_cast<double>(introspector::read_value<bool>(field_info.position));
-                return true;
-            }
-            case definition_t::primitive_type_t::INT8:
-            {
-                value = static_cast<double>(introspector::read_value<int8_t>(field_info.position));
-                return true;
-            }
-            case definition_t::primitive_type_t::INT16:
-            {
-                value = static_cast<double>(introspector::read_value<int16_t>(field_info.position));
-                return true;
-            }
-            case definition_t::primitive_type_t::INT32:
-            {
-                value = static_cast<double>(introspector::read_value<int32_t>(field_info.position));
-                return true;
-            }
-            case definition_t::primitive_type_t::INT64:
-            {
-                value = static_cast<double>(introspector::read_value<int64_t>(field_info.position));
-                return true;
-            }
-            case definition_t::primitive_type_t::UINT8:
-            {
-                value = static_cast<double>(introspector::read_value<uint8_t>(field_info.position));
-                return true;
-            }
-            case definition_t::primitive_type_t::UINT16:
-            {
-                value = static_cast<double>(introspector::read_value<uint16_t>(field_info.position));
-                return true;
-            }
-            case definition_t::primitive_type_t::UINT32:
-            {
-                value = static_cast<double>(introspector::read_value<uint32_t>(field_info.position));
-                return true;
-            }
-            case definition_t::primitive_type_t::UINT64:
-            {
-                value = static_cast<double>(introspector::read_value<uint64_t>(field_info.position));
-                return true;
-            }
-            case definition_t::primitive_type_t::FLOAT32:
-            {
-                value = static_cast<double>(introspector::read_value<float_t>(field_info.position));
-                return true;
-            }
-            case definition_t::primitive_type_t::FLOAT64:
-            {
-                value = introspector::read_value<double_t>(field_info.position);
-                return true;
-            }
-            case definition_t::primitive_type_t::STRING:
-            {
-                // First read the string.
-                // Read the string length.
-                uint32_t string_length = introspector::read_value<uint32_t>(field_info.position);
-                std::string string = std::string(reinterpret_cast<char*>(&(introspector::m_bytes[field_info.position + 4])), string_length);
+    // Only grow the storage when the message does not fit, so steady state messages never allocate.
+    if(length > introspector::m_capacity)
+    {
+        delete [] introspector::m_buffer;
+        introspector::m_buffer = new uint8_t[length];
+        introspector::m_capacity = length;
+    }
 
-                // Try to parse the string as a value.
-                try
-                {
-                    value = std::stod(string);
-                }
-                catch(...)
-                {
-                    value = std::numeric_limits<double_t>::quiet_NaN();
-                }
+    introspector::m_bytes = introspector::m_buffer;
+    introspector::m_length = length;
 
-                return true;
-            }
-            case definition_t::primitive_type_t::TIME:
-            {
-                // Convert sec/nsec to double.
-                uint32_t sec = introspector::read_value<uint32_t>(field_info.position);
-                uint32_t nsec = introspector::read_value<uint32_t>(field_info.position + 4);
-                value = static_cast<double>(sec) + static_cast<double>(nsec) / 1000000000.0;
-                return true;
-            }
-            case definition_t::primitive_type_t::DURATION:
-            {
-                // Convert sec/nsec to double.
-                uint32_t sec = introspector::read_value<uint32_t>(field_info.position);
-                uint32_t nsec = introspector::read_value<uint32_t>(field_info.position + 4);
-                value = static_cast<double>(sec) + static_cast<double>(nsec) / 1000000000.0;
-                return true;
-            }
-            case definition_t::primitive_type_t::NON_PRIMITIVE:
-            {
-                return false;
-            }
-        }
-    }
-    catch(...)
+    return introspector::m_buffer;
+}
+void introspector::borrow_bytes(const uint8_t* data, uint32_t length)
+{
+    // Release storage grown by an outlier, since borrowed messages do not need it.
+    if(introspector::m_buffer_limit != 0 && introspector::m_capacity > introspector::m_buffer_limit)
     {
-        return false;
+        introspector::release_bytes();
     }
+
+    // Read from the caller's memory.
+    introspector::m_bytes = data;
+    introspector::m_length = length;
 }
+void introspector::release_bytes()
+{
+    delete [] introspector::m_buffer;
+    introspector::m_buffer = nullptr;
+    introspector::m_capacity = 0;
 
-// PRINTING
-std::string introspector::print_components() const
+    // Release the outlier's index as well. It is rebuilt for the next message.
+    std::vector<anchor_t>().swap(introspector::m_anchors);
+    std::vector<frame_t>().swap(introspector::m_frames);
+    std::vector<loop_t>().swap(introspector::m_plan_loops);
+    std::vector<shape_entry_t>().swap(introspector::m_shape);
+    introspector::m_shape_schema = 0;
+}
+void introspector::parse_message()
 {
-    // Create output stream.
-    std::stringstream output;
+    // Start a new message, which marks the index and cached handle positions as stale.
+    ++introspector::m_message;
 
-    // Iterate over component definitions.
-    for(auto component = introspector::m_component_definitions.begin(); component != introspector::m_component_definitions.end(); ++component)
+    // Index the message.
+    // In lazy mode, the message is instead indexed when its first field is read.
+    if(!introspector::m_lazy)
     {
-        // Output component overall type.
-        output << component->first << std::endl;;
+        introspector::index_message();
+    }
+}
+void introspector::register_message(const std::string& md5, const std::string& type, const std::string& definition)
+{
+    auto start = introspector::start_timing(introspector::m_stats.registration);
 
-        // Output component fields.
-        auto& fields = component->second;
-        for(auto field = fields.begin(); field != fields.end(); ++field)
-        {
-            output << "\tname = " << field->name() << " type = " << field->type() << " array = " << field->array() << std::endl;
-        }
+    // Check if the message type was registered before and is still in the cache.
+    auto cached = introspector::m_schema_index.find(md5);
+    if(cached != introspector::m_schema_index.end())
+    {
+        // Move the cached schema to the front as the most recently used.
+        introspector::m_schemas.splice(introspector::m_schemas.begin(), introspector::m_schemas, cached->second);
+        ++introspector::m_stats.n_schema_cache_hits;
     }
+    else
+    {
+        // Get the schema from the registry, which only parses the definition once per process.
+        introspector::add_schema(registry::get_schema(md5, type, definition));
+        ++introspector::m_stats.n_registrations;
+    }
+
+    // Switch to the schema.
+    // Its patterns are kept, so paths that were read before do not need to be resolved again.
+    introspector::m_schema = &introspector::m_schemas.front();
 
-    return output.str();
+    introspector::stop_timing(introspector::m_stats.registration, start);
 }
-std::string introspector::print_definition_tree() const
+bool introspector::is_registered(const std::string& md5)
 {
-    return introspector::m_definition_tree.print();
+    return introspector::m_schema != nullptr && introspector::m_schema->schema->md5().compare(md5) == 0;
 }
-
-// COMPONENTS
-void introspector::parse_components(std::string message_type, std::string definition)
+void introspector::add_schema(const std::shared_ptr<const schema_t>& schema)
 {
-    // Clear current component definitions.
-    introspector::m_component_definitions.clear();
-
-    // Add top-level message to definition and set it as the current workspace.
-    auto* fields_workspace = &introspector::m_component_definitions[message_type];
+    // Add the schema to the front of the cache and switch to it.
+    introspector::m_schemas.emplace_front();
+    introspector::m_schemas.front().schema = schema;
+    introspector::update_interest(introspector::m_schemas.front());
+    introspector::m_schema_index[schema->md5()] = introspector::m_schemas.begin();
+    introspector::m_schema = &introspector::m_schemas.front();
 
-    // Convert description into a stringstream.
-    std::stringstream description_stream(definition);
-
-    // Set up tokenizer delimiter.
-    boost::char_separator<char> delimiter(" ");
-
-    // Iterate through description.
-    std::string current_line;
-    while(std::getline(description_stream, current_line))
+    // Evict the least recently used schema if the cache is full.
+    introspector::trim_schemas();
+}
+void introspector::trim_schemas()
+{
+    // The current schema is always at the front, so it is never evicted.
+    while(introspector::m_schemas.size() > introspector::m_schema_capacity)
     {
-        // Remove any comments from the line before tokenizing.
-        auto comment_position = current_line.find_first_of('#');
-        if(comment_position != std::string::npos)
+        // Release the schema's position cache slots, invalidating them for the handles that still refer to them.
+        const std::unordered_map<std::string, uint32_t>& slots = introspector::m_schemas.back().slots;
+        for(auto slot = slots.cbegin(); slot != slots.cend(); ++slot)
         {
-            current_line.erase(comment_position);
+            handle_cache_t& cache = introspector::m_handle_cache[slot->second];
+            ++cache.generation;
+            cache.layout = 0;
+            introspector::m_free_slots.push_back(slot->second);
         }
 
-        // Check if line is empty, an equals separator line, or defining a constant
-        if(current_line.empty() || current_line.find_first_of('=') != std::string::npos)
-        {
-            // Skip this line.
-            continue;
-        }
+        introspector::m_schema_index.erase(introspector::m_schemas.back().schema->md5());
+        introspector::m_schemas.pop_back();
+    }
+}
 
-        // Tokenize line into vector.
-        boost::tokenizer<boost::char_separator<char>> tokenizer(current_line, delimiter);
-        std::vector<std::string> tokens(tokenizer.begin(), tokenizer.end());
+// INTEREST
+void introspector::update_interest(schema_entry_t& entry) const
+{
+    const std::vector<schema_t::node_t>& nodes = entry.schema->m_nodes;
+    const schema_t::node_t& message = nodes[0];
 
-        // Check if tokens exist.
-        if(tokens.empty())
-        {
-            continue;
-        }
-        
-        // Check if first token is a new sub-message designator.
-        if(tokens[0].compare("MSG:") == 0)
+    // Every field is interesting if there is no interest set.
+    if(introspector::m_interest.empty())
+    {
+        entry.interest_fields = message.n_fields;
+        return;
+    }
+
+    // Find the last top level field that an interesting path starts with.
+    // Paths that do not exist in the message type are ignored.
+    entry.interest_fields = 0;
+    for(auto path = introspector::m_interest.cbegin(); path != introspector::m_interest.cend(); ++path)
+    {
+        size_t name_length = path->find_first_of(".[");
+        if(name_length == std::string::npos)
         {
-            // Initiate new sub-message and switch workspace to it.
-            fields_workspace = &introspector::m_component_definitions[tokens[1]];
+            name_length = path->size();
         }
-        else
+        for(uint32_t field = 0; field < message.n_fields; ++field)
         {
-            // Check if type is an array.
-            auto array_position = tokens[0].find_first_of('[');
-            std::string type = tokens[0];
-            std::string array = "";
-            if(array_position != std::string::npos)
+            const std::string& name = *(nodes[message.first_field + field].name);
+            if(name.size() == name_length && path->compare(0, name_length, name) == 0)
             {
-                array = tokens[0].substr(array_position);
-                type.erase(array_position);
+                entry.interest_fields = std::max(entry.interest_fields, field + 1);
+                break;
             }
-
-            // Create a new component definition.
-            definition_t new_component(type, array, tokens[1]);
-
-            // Add to fields workspace.
-            fields_workspace->push_back(new_component);
         }
     }
+}
 
-    // Iterate through the definition map to correct incomplete types.
-    for(auto definition = introspector::m_component_definitions.begin(); definition != introspector::m_component_definitions.end(); ++definition)
+// HANDLES
+bool introspector::get_handle(const std::string& path, field_handle_t& handle)
+{
+    // A message type must be registered to resolve against.
+    if(introspector::m_schema == nullptr)
     {
-        auto& fields = definition->second;
-        for(auto field = fields.begin(); field != fields.end(); ++field)
-        {
-            // Check if field is a primitive field.
-            if(field->is_primitive())
-            {
-                continue;
+        introspector::m_status = status_t::NO_MESSAGE;
+        return false;
+    }
+
+    // Resolve the path's route through the definition tree.
+    const schema_t::pattern_t* pattern = introspector::resolve_path(path);
+    if(pattern == nullptr || pattern->whole_array)
+    {
+        introspector::m_status = status_t::NOT_FOUND;
+        return false;
+    }
+
+    // Fixed length arrays can be bounds checked now.
+    const std::vector<schema_t::node_t>& nodes = introspector::m_schema->schema->m_nodes;
+    uint32_t node = 0;
+    for(auto step = introspector::m_route.cbegin(); step != introspector::m_route.cend(); ++step)
+    {
+        node = nodes[node].first_field + step->field;
+        const schema_t::node_t& definition = nodes[node];
+        if(definition.array_type == definition_t::array_type_t::FIXED_LENGTH && step->index >= definition.array_length)
+        {
+            introspector::m_status = status_t::OUT_OF_BOUNDS;
+            return false;
+        }
+    }
+
+    // Find the route's slot in the position cache, so resolving the same field again does not add a slot.
+    // New routes take a released slot if there is one.
+    introspector::m_route_key.assign(reinterpret_cast<const char*>(introspector::m_route.data()), introspector::m_route.size() * sizeof(field_handle_t::step_t));
+    auto slot = introspector::m_schema->slots.find(introspector::m_route_key);
+    if(slot == introspector::m_schema->slots.end())
+    {
+        uint32_t index;
+        if(introspector::m_free_slots.empty())
+        {
+            index = static_cast<uint32_t>(introspector::m_handle_cache.size());
+            introspector::m_handle_cache.push_back({0, false, {0, definition_t::primitive_type_t::NON_PRIMITIVE}, 0});
+        }
+        else
+        {
+            index = introspector::m_free_slots.back();
+            introspector::m_free_slots.pop_back();
+        }
+        slot = introspector::m_schema->slots.emplace(introspector::m_route_key, index).first;
+    }
+
+    // Populate the handle.
+    handle.m_route = introspector::m_route;
+    handle.m_schema = introspector::m_schema->schema->id();
+    handle.m_owner = introspector::m_id;
+    handle.m_slot = slot->second;
+    handle.m_generation = introspector::m_handle_cache[slot->second].generation;
+    handle.m_path = path;
+    handle.m_primitive_type = pattern->primitive_type;
+
+    introspector::m_status = status_t::OK;
+    return true;
+}
+bool introspector::is_stale(const field_handle_t& handle) const
+{
+    return introspector::m_schema == nullptr || handle.m_schema != introspector::m_schema->schema->id();
+}
+bool introspector::get_query(const std::string& path, field_query_t& query) const
+{
+    // A message type must be registered to resolve against.
+    if(introspector::m_schema == nullptr)
+    {
+        introspector::m_status = status_t::NO_MESSAGE;
+        return false;
+    }
+
+    // Split the path into its pattern and the index range of each indexed array.
+    introspector::m_pattern.clear();
+    std::vector<std::pair<uint32_t, uint32_t>> ranges;
+    for(size_t c = 0; c < path.size(); ++c)
+    {
+        introspector::m_pattern += path[c];
+        if(path[c] != '[')
+        {
+            continue;
+        }
+
+        // Find the end of the index.
+        size_t index_start = c + 1;
+        size_t index_end = path.find(']', index_start);
+        if(index_end == std::string::npos)
+        {
+            introspector::m_status = status_t::NOT_FOUND;
+            return false;
+        }
+        c = index_end;
+        introspector::m_pattern += ']';
+
+        // Parse the index as a slice or a single index. Wildcards keep the full range.
+        std::pair<uint32_t, uint32_t> range(0, std::numeric_limits<uint32_t>::max());
+        size_t colon = path.find(':', index_start);
+        bool wildcard = (index_end == index_start + 1 && path[index_start] == '*');
+        bool parsed = true;
+        if(!wildcard && colon < index_end)
+        {
+            if(colon != index_start)
+            {
+                parsed = parse_index(path, index_start, colon, range.first);
+            }
+            if(parsed && colon + 1 != index_end)
+            {
+                parsed = parse_index(path, colon + 1, index_end, range.second);
+            }
+        }
+        else if(!wildcard)
+        {
+            parsed = parse_index(path, index_start, index_end, range.first);
+            range.second = range.first + 1;
+        }
+        if(!parsed)
+        {
+            introspector::m_status = status_t::NOT_FOUND;
+            return false;
+        }
+        ranges.push_back(range);
+    }
+
+    // Resolve the pattern, which must lead to a primitive field or the elements of a primitive array.
+    const schema_t::pattern_t& pattern = introspector::find_pattern(introspector::m_pattern);
+    if(!pattern.valid || pattern.whole_array)
+    {
+        introspector::m_status = status_t::NOT_FOUND;
+        return false;
+    }
+
+    // Apply the ranges to the pattern's indexed parts to get the query's steps.
+    query.m_steps.clear();
+    auto range = ranges.cbegin();
+    for(auto part = pattern.parts.cbegin(); part != pattern.parts.cend(); ++part)
+    {
+        if(part->indexed)
+        {
+            query.m_steps.push_back({part->field, range->first, range->second});
+            ++range;
+        }
+        else
+        {
+            query.m_steps.push_back({part->field, 0, 0});
+        }
+    }
+    query.m_schema = introspector::m_schema->schema->id();
+    query.m_path = path;
+    query.m_primitive_type = pattern.primitive_type;
+
+    introspector::m_status = status_t::OK;
+    return true;
+}
+bool introspector::is_stale(const field_query_t& query) const
+{
+    return introspector::m_schema == nullptr || query.m_schema != introspector::m_schema->schema->id();
+}
+
+// GET
+introspector::status_t introspector::last_status() const
+{
+    return introspector::m_status;
+}
+bool introspector::path_exists(const std::string& path) const
+{
+    field_t field;
+    return introspector::find_field(path, field);
+}
+bool introspector::get_bool(const std::string& path, bool& value) const
+{
+    field_t field;
+    return introspector::find_field(path, field) && introspector::read_field<bool>(field, definition_t::primitive_type_t::BOOL, value);
+}
+bool introspector::get_int8(const std::string& path, int8_t& value) const
+{
+    field_t field;
+    return introspector::find_field(path, field) && introspector::read_field<int8_t>(field, definition_t::primitive_type_t::INT8, value);
+}
+bool introspector::get_int16(const std::string& path, int16_t& value) const
+{
+    field_t field;
+    return introspector::find_field(path, field) && introspector::read_field<int16_t>(field, definition_t::primitive_type_t::INT16, value);
+}
+bool introspector::get_int32(const std::string& path, int32_t& value) const
+{
+    field_t field;
+    return introspector::find_field(path, field) && introspector::read_field<int32_t>(field, definition_t::primitive_type_t::INT32, value);
+}
+bool introspector::get_int64(const std::string& path, int64_t& value) const
+{
+    field_t field;
+    return introspector::find_field(path, field) && introspector::read_field<int64_t>(field, definition_t::primitive_type_t::INT64, value);
+}
+bool introspector::get_uint8(const std::string& path, uint8_t& value) const
+{
+    field_t field;
+    return introspector::find_field(path, field) && introspector::read_field<uint8_t>(field, definition_t::primitive_type_t::UINT8, value);
+}
+bool introspector::get_uint16(const std::string& path, uint16_t& value) const
+{
+    field_t field;
+    return introspector::find_field(path, field) && introspector::read_field<uint16_t>(field, definition_t::primitive_type_t::UINT16, value);
+}
+bool introspector::get_uint32(const std::string& path, uint32_t& value) const
+{
+    field_t field;
+    return introspector::find_field(path, field) && introspector::read_field<uint32_t>(field, definition_t::primitive_type_t::UINT32, value);
+}
+bool introspector::get_uint64(const std::string& path, uint64_t& value) const
+{
+    field_t field;
+    return introspector::find_field(path, field) && introspector::read_field<uint64_t>(field, definition_t::primitive_type_t::UINT64, value);
+}
+bool introspector::get_float32(const std::string& path, float& value) const
+{
+    field_t field;
+    return introspector::find_field(path, field) && introspector::read_field<float_t>(field, definition_t::primitive_type_t::FLOAT32, value);
+}
+bool introspector::get_float64(const std::string& path, double& value) const
+{
+    field_t field;
+    return introspector::find_field(path, field) && introspector::read_field<double_t>(field, definition_t::primitive_type_t::FLOAT64, value);
+}
+bool introspector::get_string(const std::string& path, std::string& value) const
+{
+    field_t field;
+    return introspector::find_field(path, field) && introspector::read_string(field, value);
+}
+bool introspector::get_string(const std::string& path, span_t<char>& value) const
+{
+    field_t field;
+    return introspector::find_field(path, field) && introspector::read_string(field, value);
+}
+bool introspector::get_time(const std::string& path, ros::Time& value) const
+{
+    field_t field;
+    return introspector::find_field(path, field) && introspector::read_time(field, value);
+}
+bool introspector::get_duration(const std::string& path, ros::Duration& value) const
+{
+    field_t field;
+    return introspector::find_field(path, field) && introspector::read_duration(field, value);
+}
+bool introspector::get_number(const std::string& path, double& value) const
+{
+    field_t field;
+    return introspector::find_field(path, field) && introspector::read_number(field, value);
+}
+bool introspector::path_exists(const field_handle_t& handle) const
+{
+    field_t field;
+    return introspector::find_field(handle, field);
+}
+bool introspector::get_bool(const field_handle_t& handle, bool& value) const
+{
+    field_t field;
+    return introspector::find_field(handle, field) && introspector::read_field<bool>(field, definition_t::primitive_type_t::BOOL, value);
+}
+bool introspector::get_int8(const field_handle_t& handle, int8_t& value) const
+{
+    field_t field;
+    return introspector::find_field(handle, field) && introspector::read_field<int8_t>(field, definition_t::primitive_type_t::INT8, value);
+}
+bool introspector::get_int16(const field_handle_t& handle, int16_t& value) const
+{
+    field_t field;
+    return introspector::find_field(handle, field) && introspector::read_field<int16_t>(field, definition_t::primitive_type_t::INT16, value);
+}
+bool introspector::get_int32(const field_handle_t& handle, int32_t& value) const
+{
+    field_t field;
+    return introspector::find_field(handle, field) && introspector::read_field<int32_t>(field, definition_t::primitive_type_t::INT32, value);
+}
+bool introspector::get_int64(const field_handle_t& handle, int64_t& value) const
+{
+    field_t field;
+    return introspector::find_field(handle, field) && introspector::read_field<int64_t>(field, definition_t::primitive_type_t::INT64, value);
+}
+bool introspector::get_uint8(const field_handle_t& handle, uint8_t& value) const
+{
+    field_t field;
+    return introspector::find_field(handle, field) && introspector::read_field<uint8_t>(field, definition_t::primitive_type_t::UINT8, value);
+}
+bool introspector::get_uint16(const field_handle_t& handle, uint16_t& value) const
+{
+    field_t field;
+    return introspector::find_field(handle, field) && introspector::read_field<uint16_t>(field, definition_t::primitive_type_t::UINT16, value);
+}
+bool introspector::get_uint32(const field_handle_t& handle, uint32_t& value) const
+{
+    field_t field;
+    return introspector::find_field(handle, field) && introspector::read_field<uint32_t>(field, definition_t::primitive_type_t::UINT32, value);
+}
+bool introspector::get_uint64(const field_handle_t& handle, uint64_t& value) const
+{
+    field_t field;
+    return introspector::find_field(handle, field) && introspector::read_field<uint64_t>(field, definition_t::primitive_type_t::UINT64, value);
+}
+bool introspector::get_float32(const field_handle_t& handle, float& value) const
+{
+    field_t field;
+    return introspector::find_field(handle, field) && introspector::read_field<float_t>(field, definition_t::primitive_type_t::FLOAT32, value);
+}
+bool introspector::get_float64(const field_handle_t& handle, double& value) const
+{
+    field_t field;
+    return introspector::find_field(handle, field) && introspector::read_field<double_t>(field, definition_t::primitive_type_t::FLOAT64, value);
+}
+bool introspector::get_string(const field_handle_t& handle, std::string& value) const
+{
+    field_t field;
+    return introspector::find_field(handle, field) && introspector::read_string(field, value);
+}
+bool introspector::get_string(const field_handle_t& handle, span_t<char>& value) const
+{
+    field_t field;
+    return introspector::find_field(handle, field) && introspector::read_string(field, value);
+}
+bool introspector::get_time(const field_handle_t& handle, ros::Time& value) const
+{
+    field_t field;
+    return introspector::find_field(handle, field) && introspector::read_time(field, value);
+}
+bool introspector::get_duration(const field_handle_t& handle, ros::Duration& value) const
+{
+    field_t field;
+    return introspector::find_field(handle, field) && introspector::read_duration(field, value);
+}
+bool introspector::get_number(const field_handle_t& handle, double& value) const
+{
+    field_t field;
+    return introspector::find_field(handle, field) && introspector::read_number(field, value);
+}
+uint32_t introspector::get_numbers(const std::vector<std::string>& paths, double* values, uint8_t* valid) const
+{
+    // Read each path, remembering why the last failed read failed.
+    uint32_t n_read = 0;
+    status_t failure = status_t::OK;
+    for(size_t p = 0; p < paths.size(); ++p)
+    {
+        field_t field;
+        bool read = introspector::find_field(paths[p], field) && introspector::read_number(field, values[p]);
+        if(read)
+        {
+            ++n_read;
+        }
+        else
+        {
+            values[p] = std::numeric_limits<double>::quiet_NaN();
+            failure = introspector::m_status;
+        }
+        if(valid != nullptr)
+        {
+            valid[p] = read;
+        }
+    }
+
+    introspector::m_status = failure;
+    return n_read;
+}
+uint32_t introspector::get_numbers(const std::vector<field_handle_t>& handles, double* values, uint8_t* valid) const
+{
+    auto start = introspector::start_timing(introspector::m_stats.batches);
+
+    // Check the message and schema once for the whole batch.
+    status_t batch_status = status_t::OK;
+    uint64_t schema_id = 0;
+    if(introspector::m_schema == nullptr)
+    {
+        batch_status = status_t::STALE_HANDLE;
+    }
+    else if(introspector::m_bytes == nullptr)
+    {
+        batch_status = status_t::NO_MESSAGE;
+    }
+    else
+    {
+        schema_id = introspector::m_schema->schema->id();
+
+        // Index the message on the first read in lazy mode.
+        if(introspector::m_indexed != introspector::m_message)
+        {
+            introspector::index_message();
+        }
+    }
+
+    // Read each handle, remembering why the last failed read failed.
+    uint32_t n_read = 0;
+    uint32_t n_missing = 0;
+    status_t failure = status_t::OK;
+    for(size_t h = 0; h < handles.size(); ++h)
+    {
+        const field_handle_t& handle = handles[h];
+
+        // Position the handle's field, using this introspector's position cache if the handle has a slot in it.
+        status_t status = batch_status;
+        field_t field;
+        if(status == status_t::OK && handle.m_schema != schema_id)
+        {
+            status = status_t::STALE_HANDLE;
+        }
+        if(status == status_t::OK && introspector::has_slot(handle))
+        {
+            auto& cache = introspector::m_handle_cache[handle.m_slot];
+            if(cache.layout != introspector::m_layout)
+            {
+                uint32_t count;
+                cache.exists = introspector::position_field(handle.m_route, false, cache.field, count);
+                cache.layout = introspector::m_layout;
+            }
+            field = cache.field;
+            status = cache.exists ? status_t::OK : status_t::OUT_OF_BOUNDS;
+        }
+        else if(status == status_t::OK)
+        {
+            uint32_t count;
+            status = introspector::position_field(handle.m_route, false, field, count) ? status_t::OK : status_t::OUT_OF_BOUNDS;
+        }
+        if(status != status_t::OK)
+        {
+            ++n_missing;
+        }
+
+        // Convert the field.
+        if(status == status_t::OK && !introspector::read_number(field, values[h]))
+        {
+            status = introspector::m_status;
+        }
+        if(status == status_t::OK)
+        {
+            ++n_read;
+        }
+        else
+        {
+            values[h] = std::numeric_limits<double>::quiet_NaN();
+            failure = status;
+        }
+        if(valid != nullptr)
+        {
+            valid[h] = (status == status_t::OK);
+        }
+    }
+
+    // Count the batch's lookups and failures.
+    introspector::m_stats.lookups.n_calls += handles.size();
+    introspector::m_stats.n_failed_lookups += n_missing;
+    introspector::stop_timing(introspector::m_stats.batches, start);
+
+    introspector::m_status = failure;
+    return n_read;
+}
+bool introspector::get_numbers(const field_query_t& query, std::vector<double>& values) const
+{
+    auto start = introspector::start_timing(introspector::m_stats.lookups);
+    values.clear();
+
+    // Check that the query belongs to the current schema and that a message exists.
+    if(introspector::is_stale(query))
+    {
+        return introspector::end_lookup(start, status_t::STALE_HANDLE);
+    }
+    if(introspector::m_bytes == nullptr)
+    {
+        return introspector::end_lookup(start, status_t::NO_MESSAGE);
+    }
+
+    // Index the message on the first read in lazy mode.
+    if(introspector::m_indexed != introspector::m_message)
+    {
+        introspector::index_message();
+    }
+
+    // Use the index if it covers the query's top level field.
+    if(query.m_steps.front().field < introspector::m_indexed_fields)
+    {
+        introspector::collect_query(query.m_steps, 0, 0, 0, 0, false, values);
+        return introspector::end_lookup(start, status_t::OK);
+    }
+
+    // Otherwise walk through the message, which stops where the message ends.
+    return introspector::end_lookup(start, introspector::walk_query(query.m_steps, 0, 0, 0, values) ? status_t::OK : status_t::OUT_OF_BOUNDS);
+}
+
+// VISIT
+bool introspector::visit(field_visitor& visitor) const
+{
+    // Fields only exist while there is a message.
+    if(introspector::m_bytes == nullptr)
+    {
+        return false;
+    }
+
+    // Visit the top level message from the start of its bytes.
+    uint32_t position = 0;
+    return introspector::visit_instance(0, 0, visitor, position);
+}
+
+// PRINTING
+std::string introspector::print_components() const
+{
+    // Print the current schema, if one is registered.
+    if(introspector::m_schema == nullptr)
+    {
+        return "";
+    }
+    return introspector::m_schema->schema->print_components();
+}
+std::string introspector::print_definition_tree() const
+{
+    // Print the current schema, if one is registered.
+    if(introspector::m_schema == nullptr)
+    {
+        return "";
+    }
+    return introspector::m_schema->schema->print_definition_tree();
+}
+
+// DEFINITION
+std::shared_ptr<const schema_t> introspector::schema() const
+{
+    if(introspector::m_schema == nullptr)
+    {
+        return nullptr;
+    }
+    return introspector::m_schema->schema;
+}
+const definition_tree_t& introspector::definition_tree() const
+{
+    // Return an empty tree if no message type is registered.
+    if(introspector::m_schema == nullptr)
+    {
+        static const definition_tree_t empty_tree;
+        return empty_tree;
+    }
+    return introspector::m_schema->schema->definition_tree();
+}
+std::shared_ptr<const definition_tree_t> introspector::shared_definition_tree() const
+{
+    if(introspector::m_schema == nullptr)
+    {
+        return nullptr;
+    }
+    // Share ownership of the schema, which owns the tree.
+    const std::shared_ptr<const schema_t>& schema = introspector::m_schema->schema;
+    return std::shared_ptr<const definition_tree_t>(schema, &(schema->definition_tree()));
+}
+
+// FIELD INDEX
+void introspector::index_message() const
+{
+    const schema_t& schema = *(introspector::m_schema->schema);
+    const std::vector<schema_t::instruction_t>& plan = schema.m_plan;
+
+    // The index belongs to the current message, even if the message ends early.
+    introspector::m_indexed = introspector::m_message;
+
+    // Keep the index if the message has the same shape as the indexed message.
+    if(introspector::match_shape())
+    {
+        ++introspector::m_stats.n_reused_layouts;
+
+        // Positions beyond the index were found by walking the previous message, so they are not kept.
+        if(introspector::m_indexed_fields + 1 < schema.m_prefixes.size())
+        {
+            ++introspector::m_layout;
+        }
+        return;
+    }
+
+    // Otherwise start a new layout, recording its shape while the plan runs.
+    ++introspector::m_layout;
+    introspector::m_indexed_fields = 0;
+    introspector::m_shape_schema = 0;
+    introspector::m_shape.clear();
+
+    // Only run the plan up to the end of the interesting fields.
+    const schema_t::prefix_t& prefix = schema.m_prefixes[introspector::m_schema->interest_fields];
+
+    // Start with the top level message's frame.
+    // The index's storage is cleared rather than released, so it is reused by the next message.
+    introspector::m_anchors.clear();
+    introspector::m_frames.clear();
+    introspector::m_plan_loops.clear();
+    introspector::m_frames.push_back({0, 0});
+    introspector::m_anchors.resize(schema.m_layout[0].anchors);
+    uint32_t frame = 0;
+
+    // Run the decoder plan from the start of the message.
+    uint32_t current_position = 0;
+    uint32_t i = 0;
+    while(i < prefix.plan_end)
+    {
+        const schema_t::instruction_t& instruction = plan[i];
+        switch(instruction.opcode)
+        {
+            case schema_t::opcode_t::ADVANCE:
+            {
+                // Move past the current run of fixed size fields.
+                if(static_cast<uint64_t>(current_position) + instruction.size > introspector::m_length)
+                {
+                    return;
+                }
+                current_position += instruction.size;
+                ++i;
+                break;
+            }
+            case schema_t::opcode_t::STRING:
+            {
+                // Read the string's length, converting from little endian.
+                if(static_cast<uint64_t>(current_position) + 4 > introspector::m_length)
+                {
+                    return;
+                }
+                uint32_t length = le32toh(introspector::read_value<uint32_t>(current_position));
+                introspector::m_shape.push_back({current_position, length});
+                uint64_t end_position = static_cast<uint64_t>(current_position) + 4 + length;
+                if(end_position > introspector::m_length)
+                {
+                    return;
+                }
+
+                // Index the string and move past it.
+                introspector::m_anchors[introspector::m_frames[frame].first_anchor + instruction.slot] = {current_position, static_cast<uint32_t>(end_position), 0, 0};
+                current_position = static_cast<uint32_t>(end_position);
+                ++i;
+                break;
+            }
+            case schema_t::opcode_t::ARRAY:
+            {
+                // Get the number of elements, reading the length if it is serialized.
+                uint32_t count = instruction.count;
+                if(count == 0)
+                {
+                    if(static_cast<uint64_t>(current_position) + 4 > introspector::m_length)
+                    {
+                        return;
+                    }
+                    count = le32toh(introspector::read_value<uint32_t>(current_position));
+                    introspector::m_shape.push_back({current_position, count});
+                    current_position += 4;
+                }
+
+                // Index the array.
+                uint32_t anchor = introspector::m_frames[frame].first_anchor + instruction.slot;
+                introspector::m_anchors[anchor] = {current_position, current_position, count, 0};
+
+                // Elements with a fixed size are jumped over all at once.
+                if(instruction.stride != 0 || count == 0)
+                {
+                    uint64_t end_position = current_position + static_cast<uint64_t>(count) * instruction.stride;
+                    if(end_position > introspector::m_length)
+                    {
+                        return;
+                    }
+                    current_position = static_cast<uint32_t>(end_position);
+                    introspector::m_anchors[anchor].end = current_position;
+                    i = instruction.jump + 1;
+                    break;
+                }
+
+                // Elements with a variable size hold at least one length, so larger counts cannot fit in the message.
+                if(count > (introspector::m_length - current_position) / 4)
+                {
+                    return;
+                }
+
+                // Give each element a frame, and start with the first element.
+                uint32_t first_frame = static_cast<uint32_t>(introspector::m_frames.size());
+                introspector::m_anchors[anchor].first_frame = first_frame;
+                introspector::m_frames.resize(first_frame + count);
+                introspector::m_plan_loops.push_back({i, count, 0, anchor, frame});
+                frame = first_frame;
+                introspector::m_frames[frame] = {current_position, static_cast<uint32_t>(introspector::m_anchors.size())};
+                introspector::m_anchors.resize(introspector::m_anchors.size() + instruction.anchors);
+                ++i;
+                break;
+            }
+            case schema_t::opcode_t::END_ARRAY:
+            {
+                // Move to the array's next element, or leave the array once all elements are done.
+                loop_t& loop = introspector::m_plan_loops.back();
+                if(++loop.index < loop.count)
+                {
+                    frame = introspector::m_anchors[loop.anchor].first_frame + loop.index;
+                    introspector::m_frames[frame] = {current_position, static_cast<uint32_t>(introspector::m_anchors.size())};
+                    introspector::m_anchors.resize(introspector::m_anchors.size() + plan[loop.instruction].anchors);
+                    i = loop.instruction + 1;
+                }
+                else
+                {
+                    introspector::m_anchors[loop.anchor].end = current_position;
+                    frame = loop.frame;
+                    introspector::m_plan_loops.pop_back();
+                    ++i;
+                }
+                break;
+            }
+        }
+    }
+
+    // Check that the fixed size fields at the end of the prefix lie within the message.
+    if(static_cast<uint64_t>(current_position) + prefix.run_size > introspector::m_length)
+    {
+        return;
+    }
+
+    introspector::m_indexed_fields = introspector::m_schema->interest_fields;
+
+    // The shape is complete, so the next message can be matched against it.
+    introspector::m_shape_schema = schema.id();
+    introspector::m_shape_length = introspector::m_length;
+}
+bool introspector::match_shape() const
+{
+    // The shape must be complete, and must belong to the same schema and interest set.
+    if(introspector::m_shape_schema != introspector::m_schema->schema->id() ||
+       introspector::m_shape_length != introspector::m_length ||
+       introspector::m_indexed_fields != introspector::m_schema->interest_fields)
+    {
+        return false;
+    }
+
+    // Compare each length that was read while indexing the previous message.
+    for(auto entry = introspector::m_shape.cbegin(); entry != introspector::m_shape.cend(); ++entry)
+    {
+        if(le32toh(introspector::read_value<uint32_t>(entry->position)) != entry->length)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+bool introspector::position_field(const std::vector<field_handle_t::step_t>& route, bool array, field_t& field, uint32_t& count) const
+{
+    // Index the message on the first read in lazy mode.
+    if(introspector::m_indexed != introspector::m_message)
+    {
+        introspector::index_message();
+    }
+
+    // Use the index if it covers the route's top level field.
+    if(route.front().field < introspector::m_indexed_fields)
+    {
+        return introspector::compute_position(route, array, field, count);
+    }
+
+    // Otherwise walk the route, which checks the bounds of each step.
+    if(array)
+    {
+        return introspector::locate_array(route, field, count);
+    }
+    return introspector::locate_field(route, field);
+}
+bool introspector::compute_position(const std::vector<field_handle_t::step_t>& route, bool array, field_t& field, uint32_t& count) const
+{
+    const std::vector<schema_t::node_t>& nodes = introspector::m_schema->schema->m_nodes;
+    const std::vector<schema_t::layout_t>& layout = introspector::m_schema->schema->m_layout;
+
+    // Start at the top level message's frame.
+    uint32_t node = 0;
+    uint32_t frame = 0;
+    uint32_t position = 0;
+    // Inside elements with a fixed size, fields are found by their offset from their parent.
+    bool fixed = false;
+
+    // Follow each step of the route.
+    for(size_t s = 0; s < route.size(); ++s)
+    {
+        const field_handle_t::step_t& step = route[s];
+        node = nodes[node].first_field + step.field;
+        const schema_t::layout_t& node_layout = layout[node];
+        const schema_t::node_t& definition = nodes[node];
+
+        // Find the node's position.
+        if(fixed)
+        {
+            position += node_layout.offset;
+        }
+        else
+        {
+            const frame_t& current_frame = introspector::m_frames[frame];
+            position = (node_layout.anchor < 0 ? current_frame.position : introspector::m_anchors[current_frame.first_anchor + node_layout.anchor].end) + node_layout.offset;
+        }
+        if(!definition.is_array())
+        {
+            continue;
+        }
+
+        // Get the array's first element and number of elements.
+        // Fixed length arrays of fixed size elements lie within their run, and other arrays are anchors.
+        const anchor_t* anchor = nullptr;
+        uint32_t n_elements = definition.array_length;
+        if(!schema_t::is_folded(definition))
+        {
+            anchor = &(introspector::m_anchors[introspector::m_frames[frame].first_anchor + node_layout.slot]);
+            n_elements = anchor->count;
+            position = anchor->position;
+        }
+
+        // Whole arrays end the route.
+        if(array && s + 1 == route.size())
+        {
+            field = {position, definition.primitive_type};
+            count = n_elements;
+            return true;
+        }
+
+        // Move to the step's element.
+        if(step.index >= n_elements)
+        {
+            return false;
+        }
+        if(definition.fixed_size)
+        {
+            position += step.index * definition.serialized_size;
+            fixed = true;
+        }
+        else
+        {
+            frame = anchor->first_frame + step.index;
+            position = introspector::m_frames[frame].position;
+        }
+    }
+
+    field = {position, nodes[node].primitive_type};
+    return true;
+}
+
+// PATHS
+const schema_t::pattern_t* introspector::resolve_path(const std::string& path) const
+{
+    // Split the path into its pattern and array indices.
+    introspector::m_pattern.clear();
+    introspector::m_indices.clear();
+    for(size_t c = 0; c < path.size(); ++c)
+    {
+        introspector::m_pattern += path[c];
+        if(path[c] == '[')
+        {
+            // Parse the index, which must be a complete unsigned number closed by a bracket.
+            uint64_t index = 0;
+            size_t index_start = ++c;
+            for(; c < path.size() && path[c] >= '0' && path[c] <= '9'; ++c)
+            {
+                index = index * 10 + static_cast<uint64_t>(path[c] - '0');
+                if(index > std::numeric_limits<uint32_t>::max())
+                {
+                    return nullptr;
+                }
+            }
+            if(c == index_start || c == path.size() || path[c] != ']')
+            {
+                return nullptr;
+            }
+            introspector::m_pattern += ']';
+            introspector::m_indices.push_back(static_cast<uint32_t>(index));
+        }
+    }
+
+    // Get the pattern.
+    const schema_t::pattern_t& pattern = introspector::find_pattern(introspector::m_pattern);
+    if(!pattern.valid)
+    {
+        return nullptr;
+    }
+
+    // Apply the indices to the pattern's indexed parts to get the route.
+    introspector::m_route.clear();
+    auto index = introspector::m_indices.cbegin();
+    for(auto part = pattern.parts.cbegin(); part != pattern.parts.cend(); ++part)
+    {
+        introspector::m_route.push_back({part->field, part->indexed ? *(index++) : 0});
+    }
+
+    return &pattern;
+}
+const schema_t::pattern_t& introspector::find_pattern(const std::string& pattern) const
+{
+    // Resolve the pattern against the schema the first time it is seen.
+    auto& patterns = introspector::m_schema->patterns;
+    auto entry = patterns.find(pattern);
+    if(entry == patterns.end())
+    {
+        entry = patterns.emplace(pattern, schema_t::pattern_t()).first;
+        introspector::m_schema->schema->resolve_pattern(pattern, entry->second);
+    }
+    return entry->second;
+}
+bool introspector::find_field(const std::string& path, field_t& field) const
+{
+    auto start = introspector::start_timing(introspector::m_stats.lookups);
+
+    // Fields only exist while there is a message.
+    if(introspector::m_bytes == nullptr)
+    {
+        return introspector::end_lookup(start, status_t::NO_MESSAGE);
+    }
+
+    // Resolve the path, which must not be a whole array.
+    const schema_t::pattern_t* pattern = introspector::resolve_path(path);
+    if(pattern == nullptr || pattern->whole_array)
+    {
+        return introspector::end_lookup(start, status_t::NOT_FOUND);
+    }
+
+    // Position the field, which fails if an index is out of bounds.
+    uint32_t count;
+    return introspector::end_lookup(start, introspector::position_field(introspector::m_route, false, field, count) ? status_t::OK : status_t::OUT_OF_BOUNDS);
+}
+bool introspector::find_array(const std::string& path, field_t& field, uint32_t& count) const
+{
+    auto start = introspector::start_timing(introspector::m_stats.lookups);
+
+    // Arrays only exist while there is a message.
+    if(introspector::m_bytes == nullptr)
+    {
+        return introspector::end_lookup(start, status_t::NO_MESSAGE);
+    }
+
+    // Resolve the path, which must be a whole array.
+    const schema_t::pattern_t* pattern = introspector::resolve_path(path);
+    if(pattern == nullptr || !pattern->whole_array)
+    {
+        return introspector::end_lookup(start, status_t::NOT_FOUND);
+    }
+
+    // Position the array, which fails if an index is out of bounds.
+    return introspector::end_lookup(start, introspector::position_field(introspector::m_route, true, field, count) ? status_t::OK : status_t::OUT_OF_BOUNDS);
+}
+
+// HANDLE POSITIONING
+bool introspector::find_field(const field_handle_t& handle, field_t& field) const
+{
+    auto start = introspector::start_timing(introspector::m_stats.lookups);
+
+    // Check that the handle belongs to the current schema and that a message exists.
+    if(introspector::is_stale(handle))
+    {
+        return introspector::end_lookup(start, status_t::STALE_HANDLE);
+    }
+    if(introspector::m_bytes == nullptr)
+    {
+        return introspector::end_lookup(start, status_t::NO_MESSAGE);
+    }
+
+    // Handles resolved by another introspector, or whose slot was released, are positioned directly.
+    uint32_t count;
+    if(!introspector::has_slot(handle))
+    {
+        return introspector::end_lookup(start, introspector::position_field(handle.m_route, false, field, count) ? status_t::OK : status_t::OUT_OF_BOUNDS);
+    }
+
+    // Index the message on the first read in lazy mode, which determines the message's layout.
+    if(introspector::m_indexed != introspector::m_message)
+    {
+        introspector::index_message();
+    }
+
+    // Position the field if it hasn't already been positioned in this layout.
+    auto& cache = introspector::m_handle_cache[handle.m_slot];
+    if(cache.layout != introspector::m_layout)
+    {
+        cache.exists = introspector::position_field(handle.m_route, false, cache.field, count);
+        cache.layout = introspector::m_layout;
+    }
+
+    field = cache.field;
+    return introspector::end_lookup(start, cache.exists ? status_t::OK : status_t::OUT_OF_BOUNDS);
+}
+bool introspector::has_slot(const field_handle_t& handle) const
+{
+    return handle.m_owner == introspector::m_id && introspector::m_handle_cache[handle.m_slot].generation == handle.m_generation;
+}
+bool introspector::locate_field(const std::vector<field_handle_t::step_t>& route, field_t& field) const
+{
+    // Follow the route to the field.
+    uint32_t current_node = 0;
+    uint32_t current_position = 0;
+    if(!introspector::follow_route(route, route.size(), current_node, current_position))
+    {
+        return false;
+    }
+
+    // Verify that the field itself lies within the message, including the characters of strings.
+    uint32_t field_end = current_position;
+    if(!introspector::skip_instance(current_node, field_end))
+    {
+        return false;
+    }
+
+    field = {current_position, introspector::m_schema->schema->m_nodes[current_node].primitive_type};
+    return true;
+}
+bool introspector::locate_array(const std::vector<field_handle_t::step_t>& route, field_t& field, uint32_t& count) const
+{
+    // Follow the route to the instance that contains the array.
+    uint32_t current_node = 0;
+    uint32_t current_position = 0;
+    if(!introspector::follow_route(route, route.size() - 1, current_node, current_position))
+    {
+        return false;
+    }
+
+    // Move to the array and get its number of elements.
+    if(!introspector::enter_field(route.back(), current_node, current_position) || !introspector::read_length(current_node, current_position, count))
+    {
+        return false;
+    }
+
+    // Verify that all elements lie within the message.
+    const schema_t::node_t& definition = introspector::m_schema->schema->m_nodes[current_node];
+    uint64_t array_end = current_position + static_cast<uint64_t>(count) * definition.serialized_size;
+    if(array_end > introspector::m_length)
+    {
+        return false;
+    }
+
+    field = {current_position, definition.primitive_type};
+    return true;
+}
+bool introspector::follow_route(const std::vector<field_handle_t::step_t>& route, size_t n_steps, uint32_t& current_node, uint32_t& current_position) const
+{
+    // Start at the top level message.
+    current_node = 0;
+    current_position = 0;
+
+    // Follow each step of the route.
+    for(size_t s = 0; s < n_steps; ++s)
+    {
+        const field_handle_t::step_t& step = route[s];
+
+        // Move to the step's field.
+        if(!introspector::enter_field(step, current_node, current_position))
+        {
+            return false;
+        }
+
+        // Move to the step's array element.
+        const schema_t::node_t& definition = introspector::m_schema->schema->m_nodes[current_node];
+        if(definition.is_array())
+        {
+            // Get the number of elements in the array.
+            uint32_t instances = 0;
+            if(!introspector::read_length(current_node, current_position, instances) || step.index >= instances)
+            {
+                return false;
             }
 
-            // Check if the field's type definition exists in the definition map.
-            if(introspector::m_component_definitions.count(field->type()) == 0)
+            // Elements with a fixed size can be jumped over directly.
+            if(definition.fixed_size)
+            {
+                uint64_t element_position = current_position + static_cast<uint64_t>(step.index) * definition.serialized_size;
+                if(element_position > introspector::m_length)
+                {
+                    return false;
+                }
+                current_position = static_cast<uint32_t>(element_position);
+            }
+            else
             {
-                // Exact typename not found. Search through definitions to find the matching full type name.
-                for(auto candidate = introspector::m_component_definitions.begin(); candidate != introspector::m_component_definitions.end(); ++ candidate)
+                for(uint32_t i = 0; i < step.index; ++i)
                 {
-                    // Check if partial type matches full candidate type.
-                    if(candidate->first.find(field->type()) != std::string::npos)
+                    if(!introspector::skip_instance(current_node, current_position))
                     {
-                        // Match found. Update partial type to full type.
-                        field->update_type(candidate->first);
-                        // Stop search.
-                        break;
+                        return false;
                     }
                 }
             }
         }
     }
-}
 
-// DEFINITION
-void introspector::add_definition(const std::string& parent_path, definition_tree_t& definition_tree, const definition_t& component_definition)
+    return true;
+}
+bool introspector::enter_field(const field_handle_t::step_t& step, uint32_t& current_node, uint32_t& current_position) const
 {
-    // Set the tree's definition.
-    definition_tree.definition = component_definition;
-    definition_tree.definition.update_parent_path(parent_path);
-
-    // Find the definition's type.
-    if(!component_definition.is_primitive())
+    // Skip over the fields that come before the step's field in the current instance.
+    uint32_t first_field = introspector::m_schema->schema->m_nodes[current_node].first_field;
+    for(uint32_t i = 0; i < step.field; ++i)
     {
-        // This definition's type is NOT primitive, so it has fields to it.
-
-        // Initialize the definition's size to 0 so it can be summed over the fields.
-        uint32_t total_size = 0;
-
-        // Get the fields of this definition from the component map.
-        auto fields = introspector::m_component_definitions[component_definition.type()];
-        // Iterate through each field to add it recursively to the definition.
-        for(auto field = fields.begin(); field != fields.end(); ++field)
+        if(!introspector::skip_definition(first_field + i, current_position))
         {
-            // Add a new definition to the array BEFORE populating it for copy efficiency.
-            definition_tree.fields.push_back(definition_tree_t());
-            auto& field_reference = definition_tree.fields.back();
-            // Now add the details to the field recursively and in place.
-            introspector::add_definition(definition_tree.definition.path(), field_reference, *field);
-            // Add field's computed size to the definition's size.
-            total_size += field_reference.definition.size();
+            return false;
         }
-
-        // Update the top level size.
-        definition_tree.definition.update_size(total_size);
     }
+    current_node = first_field + step.field;
+
+    return true;
 }
-definition_tree_t introspector::definition_tree() const
+bool introspector::read_length(uint32_t node, uint32_t& position, uint32_t& length) const
 {
-    return introspector::m_definition_tree;
-}
+    // Fixed length arrays do not serialize their length.
+    const schema_t::node_t& definition = introspector::m_schema->schema->m_nodes[node];
+    if(definition.array_type != definition_t::array_type_t::VARIABLE_LENGTH)
+    {
+        length = definition.array_length;
+        return true;
+    }
 
-// POSITIONING
-void introspector::update_field_map(const definition_tree_t& definition_tree, const std::string& current_path, uint32_t& current_position)
-{
-    // Build the path to this tree.
-    std::string path = current_path;
-    if(!path.empty())
+    // Read the length, converting from little endian.
+    if(static_cast<uint64_t>(position) + 4 > introspector::m_length)
     {
-        path += ".";
+        return false;
     }
-    path += definition_tree.definition.name();
+    length = le32toh(introspector::read_value<uint32_t>(position));
+    position += 4;
+
+    return true;
+}
+bool introspector::skip_definition(uint32_t node, uint32_t& position) const
+{
+    const schema_t::node_t& definition = introspector::m_schema->schema->m_nodes[node];
 
-    // This tree may or may not be an array.
     // Use array information to determine number of instances.
-    uint32_t instances;
-    switch(definition_tree.definition.array_type())
+    uint32_t instances = 1;
+    switch(definition.array_type)
     {
         case definition_t::array_type_t::NONE:
         {
-            instances = 1;
             break;
         }
         case definition_t::array_type_t::FIXED_LENGTH:
         {
-            instances = definition_tree.definition.array_length();
+            instances = definition.array_length;
             break;
         }
         case definition_t::array_type_t::VARIABLE_LENGTH:
         {
             // Read the length, converting from little endian.
-            instances = le32toh(*reinterpret_cast<uint32_t*>(&introspector::m_bytes[current_position]));
-            // Update current position to account for the length bytes;
-            current_position += 4;
+            if(static_cast<uint64_t>(position) + 4 > introspector::m_length)
+            {
+                return false;
+            }
+            instances = le32toh(introspector::read_value<uint32_t>(position));
+            position += 4;
             break;
         }
     }
 
-    // Check if this tree is primitive or not.
-    if(definition_tree.definition.is_primitive())
+    // Fixed size instances can be skipped all at once.
+    if(definition.fixed_size)
+    {
+        uint64_t end_position = position + static_cast<uint64_t>(instances) * definition.serialized_size;
+        if(end_position > introspector::m_length)
+        {
+            return false;
+        }
+        position = static_cast<uint32_t>(end_position);
+        return true;
+    }
+
+    // Otherwise skip each instance individually.
+    for(uint32_t i = 0; i < instances; ++i)
+    {
+        if(!introspector::skip_instance(node, position))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+bool introspector::skip_instance(uint32_t node, uint32_t& position) const
+{
+    const schema_t::node_t& definition = introspector::m_schema->schema->m_nodes[node];
+
+    // Fixed size instances can be skipped directly.
+    if(definition.fixed_size)
+    {
+        uint64_t end_position = static_cast<uint64_t>(position) + definition.serialized_size;
+        if(end_position > introspector::m_length)
+        {
+            return false;
+        }
+        position = static_cast<uint32_t>(end_position);
+        return true;
+    }
+
+    // Strings are the only variable sized primitive.
+    if(definition.is_primitive())
+    {
+        if(static_cast<uint64_t>(position) + 4 > introspector::m_length)
+        {
+            return false;
+        }
+        uint64_t end_position = static_cast<uint64_t>(position) + 4 + le32toh(introspector::read_value<uint32_t>(position));
+        if(end_position > introspector::m_length)
+        {
+            return false;
+        }
+        position = static_cast<uint32_t>(end_position);
+        return true;
+    }
+
+    // Skip over each field of the instance.
+    for(uint32_t field = definition.first_field; field < definition.first_field + definition.n_fields; ++field)
+    {
+        if(!introspector::skip_definition(field, position))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// QUERIES
+void introspector::collect_query(const std::vector<field_query_t::step_t>& steps, size_t s, uint32_t node, uint32_t frame, uint32_t position, bool fixed, std::vector<double>& values) const
+{
+    const std::vector<schema_t::node_t>& nodes = introspector::m_schema->schema->m_nodes;
+    const std::vector<schema_t::layout_t>& layout = introspector::m_schema->schema->m_layout;
+
+    // Follow each step until the next array.
+    for(; s < steps.size(); ++s)
     {
-        // Iterate over instances.
-        for(uint32_t i = 0; i < instances; ++i)
+        const field_query_t::step_t& step = steps[s];
+        node = nodes[node].first_field + step.field;
+        const schema_t::layout_t& node_layout = layout[node];
+        const schema_t::node_t& definition = nodes[node];
+
+        // Find the node's position.
+        if(fixed)
+        {
+            position += node_layout.offset;
+        }
+        else
+        {
+            const frame_t& current_frame = introspector::m_frames[frame];
+            position = (node_layout.anchor < 0 ? current_frame.position : introspector::m_anchors[current_frame.first_anchor + node_layout.anchor].end) + node_layout.offset;
+        }
+        if(!definition.is_array())
+        {
+            continue;
+        }
+
+        // Get the array's first element and number of elements.
+        // Fixed length arrays of fixed size elements lie within their run, and other arrays are anchors.
+        const anchor_t* anchor = nullptr;
+        uint32_t n_elements = definition.array_length;
+        if(!schema_t::is_folded(definition))
+        {
+            anchor = &(introspector::m_anchors[introspector::m_frames[frame].first_anchor + node_layout.slot]);
+            n_elements = anchor->count;
+            position = anchor->position;
+        }
+
+        // Arrays of fixed size primitives are converted directly.
+        uint32_t end = std::min(step.end, n_elements);
+        if(s + 1 == steps.size() && definition.fixed_size)
         {
-            // Build path for this instance.
-            std::string instance_path = path;
-            if(definition_tree.definition.is_array())
+            number_converter_t converter = s_number_converters[static_cast<size_t>(definition.primitive_type)];
+            for(uint32_t i = step.begin; i < end; ++i)
             {
-                instance_path += "[" + std::to_string(i) + "]";
+                values.push_back(converter(&(introspector::m_bytes[position + i * definition.serialized_size])));
             }
+            return;
+        }
 
-            // Add instance to field map.
-            introspector::m_field_map[instance_path] = {current_position, definition_tree.definition.primitive_type()};
-
-            // Check if string.
-            if(definition_tree.definition.primitive_type() == definition_t::primitive_type_t::STRING)
+        // Otherwise collect the remaining steps from each element in the step's range.
+        for(uint32_t i = step.begin; i < end; ++i)
+        {
+            if(definition.fixed_size)
             {
-                // Read string length, converting from little endian.
-                uint32_t string_length = le32toh(*reinterpret_cast<uint32_t*>(&introspector::m_bytes[current_position]));
-                // Update current position.
-                current_position += 4 + string_length;
+                introspector::collect_query(steps, s + 1, node, frame, position + i * definition.serialized_size, true, values);
             }
             else
             {
-                // Update current position with this primitive type's size.
-                current_position += definition_tree.definition.size();
+                uint32_t element_frame = anchor->first_frame + i;
+                introspector::collect_query(steps, s + 1, node, element_frame, introspector::m_frames[element_frame].position, false, values);
+            }
+        }
+        return;
+    }
+
+    // Read the field.
+    double value;
+    introspector::read_number({position, nodes[node].primitive_type}, value);
+    values.push_back(value);
+}
+bool introspector::walk_query(const std::vector<field_query_t::step_t>& steps, size_t s, uint32_t node, uint32_t position, std::vector<double>& values) const
+{
+    const std::vector<schema_t::node_t>& nodes = introspector::m_schema->schema->m_nodes;
+
+    // Follow each step until the next array.
+    for(; s < steps.size(); ++s)
+    {
+        // Move to the step's field.
+        const field_query_t::step_t& step = steps[s];
+        if(!introspector::enter_field({step.field, 0}, node, position))
+        {
+            return false;
+        }
+        if(!nodes[node].is_array())
+        {
+            continue;
+        }
+
+        // Get the number of elements in the array.
+        uint32_t n_elements = 0;
+        if(!introspector::read_length(node, position, n_elements))
+        {
+            return false;
+        }
+
+        // Collect the remaining steps from each element in the step's range, skipping over the elements in between.
+        uint32_t end = std::min(step.end, n_elements);
+        for(uint32_t i = 0; i < end; ++i)
+        {
+            if(i >= step.begin && !introspector::walk_query(steps, s + 1, node, position, values))
+            {
+                return false;
+            }
+            if(i + 1 < end && !introspector::skip_instance(node, position))
+            {
+                return false;
             }
         }
+        return true;
+    }
+
+    // Verify that the field itself lies within the message, including the characters of strings.
+    uint32_t field_end = position;
+    if(!introspector::skip_instance(node, field_end))
+    {
+        return false;
+    }
+
+    // Read the field.
+    double value;
+    introspector::read_number({position, nodes[node].primitive_type}, value);
+    values.push_back(value);
+    return true;
+}
+
+// VISITING
+bool introspector::visit_node(uint32_t node, field_visitor& visitor, uint32_t& position) const
+{
+    const schema_t::node_t& definition = introspector::m_schema->schema->m_nodes[node];
+
+    // Non-array nodes have a single instance.
+    if(!definition.is_array())
+    {
+        return introspector::visit_instance(node, 0, visitor, position);
+    }
+
+    // Get the number of elements in the array.
+    uint32_t length;
+    if(!introspector::read_length(node, position, length))
+    {
+        return false;
+    }
+    visitor.on_array_begin(definition, node, length);
+
+    if(definition.is_primitive() && definition.fixed_size)
+    {
+        // Pass arrays of fixed size primitives all at once.
+        uint64_t size = static_cast<uint64_t>(length) * definition.serialized_size;
+        if(position + size > introspector::m_length)
+        {
+            return false;
+        }
+        visitor.on_primitive_array(definition, node, introspector::m_bytes + position, length);
+        position += static_cast<uint32_t>(size);
     }
     else
     {
-        // Tree is not a primitive type, and thus has children.
-        // For each instance, recurse into that instance's children.
-        for(uint32_t i = 0; i < instances; ++i)
+        // Visit each element in turn.
+        for(uint32_t index = 0; index < length; ++index)
         {
-            // Build path for this instance.
-            std::string instance_path = path;
-            if(definition_tree.definition.is_array())
+            if(!introspector::visit_instance(node, index, visitor, position))
             {
-                instance_path += "[" + std::to_string(i) + "]";
+                return false;
             }
+        }
+    }
+
+    visitor.on_array_end(definition, node);
+
+    return true;
+}
+bool introspector::visit_instance(uint32_t node, uint32_t index, field_visitor& visitor, uint32_t& position) const
+{
+    const schema_t::node_t& definition = introspector::m_schema->schema->m_nodes[node];
 
-            // Iterate through fields.
-            for(auto field = definition_tree.fields.begin(); field != definition_tree.fields.end(); ++field)
+    // Pass primitives to the visitor.
+    if(definition.is_primitive())
+    {
+        // Strings are passed without their serialized length.
+        if(definition.primitive_type == definition_t::primitive_type_t::STRING)
+        {
+            if(static_cast<uint64_t>(position) + 4 > introspector::m_length)
+            {
+                return false;
+            }
+            uint32_t length = le32toh(introspector::read_value<uint32_t>(position));
+            if(static_cast<uint64_t>(position) + 4 + length > introspector::m_length)
+            {
+                return false;
+            }
+            visitor.on_field(definition, node, index, introspector::m_bytes + position + 4, length);
+            position += 4 + length;
+        }
+        else
+        {
+            uint32_t size = definition.serialized_size;
+            if(static_cast<uint64_t>(position) + size > introspector::m_length)
             {
-                // Recurse into field.
-                // Use a reset current position as they are all relative to their parent.
-                introspector::update_field_map(*field, instance_path, current_position);
+                return false;
             }
+            visitor.on_field(definition, node, index, introspector::m_bytes + position, size);
+            position += size;
+        }
+        return true;
+    }
+
+    // Visit each of the message's fields in order.
+    visitor.on_message_begin(definition, node, index);
+    for(uint32_t field = definition.first_field; field < definition.first_field + definition.n_fields; ++field)
+    {
+        if(!introspector::visit_node(field, visitor, position))
+        {
+            return false;
+        }
+    }
+    visitor.on_message_end(definition, node);
+
+    return true;
+}
+
+// FIELD READING
+bool introspector::read_string(const field_t& field, std::string& value) const
+{
+    // Check field type.
+    if(field.primitive_type != definition_t::primitive_type_t::STRING)
+    {
+        introspector::m_status = status_t::TYPE_MISMATCH;
+        return false;
+    }
+
+    // Read the strings length, and check that its characters lie within the message.
+    uint32_t string_length;
+    if(!introspector::read_string_length(field, string_length))
+    {
+        return false;
+    }
+
+    // Read the string, reusing the value's storage.
+    value.assign(reinterpret_cast<const char*>(&(introspector::m_bytes[field.position + 4])), string_length);
+
+    return true;
+}
+bool introspector::read_string(const field_t& field, span_t<char>& value) const
+{
+    // Check field type.
+    if(field.primitive_type != definition_t::primitive_type_t::STRING)
+    {
+        introspector::m_status = status_t::TYPE_MISMATCH;
+        return false;
+    }
+
+    // Read the strings length, and check that its characters lie within the message.
+    uint32_t string_length;
+    if(!introspector::read_string_length(field, string_length))
+    {
+        return false;
+    }
+
+    // View the string's characters, which follow its length.
+    value = span_t<char>(&(introspector::m_bytes[field.position + 4]), string_length);
+
+    return true;
+}
+bool introspector::read_string_length(const field_t& field, uint32_t& length) const
+{
+    // Check that both the length and the characters it counts lie within the message.
+    if(static_cast<uint64_t>(field.position) + 4 > introspector::m_length)
+    {
+        introspector::m_status = status_t::OUT_OF_BOUNDS;
+        return false;
+    }
+    length = le32toh(introspector::read_value<uint32_t>(field.position));
+    if(static_cast<uint64_t>(field.position) + 4 + length > introspector::m_length)
+    {
+        introspector::m_status = status_t::OUT_OF_BOUNDS;
+        return false;
+    }
+
+    return true;
+}
+bool introspector::read_time(const field_t& field, ros::Time& value) const
+{
+    // Check field type.
+    if(field.primitive_type != definition_t::primitive_type_t::TIME)
+    {
+        introspector::m_status = status_t::TYPE_MISMATCH;
+        return false;
+    }
+
+    // Extract secs and nsecs.
+    value.sec = introspector::read_value<uint32_t>(field.position);
+    value.nsec = introspector::read_value<uint32_t>(field.position + 4);
+
+    return true;
+}
+bool introspector::read_duration(const field_t& field, ros::Duration& value) const
+{
+    // Check field type.
+    if(field.primitive_type != definition_t::primitive_type_t::DURATION)
+    {
+        introspector::m_status = status_t::TYPE_MISMATCH;
+        return false;
+    }
+
+    // Extract secs and nsecs.
+    value.sec = introspector::read_value<uint32_t>(field.position);
+    value.nsec = introspector::read_value<uint32_t>(field.position + 4);
+
+    return true;
+}
+bool introspector::read_number(const field_t& field, double& value) const
+{
+    // Convert numbers, times and durations with their primitive type's converter.
+    number_converter_t converter = s_number_converters[static_cast<size_t>(field.primitive_type)];
+    if(converter != nullptr)
+    {
+        value = converter(&(introspector::m_bytes[field.position]));
+        return true;
+    }
+
+    // Strings are parsed as numbers.
+    if(field.primitive_type == definition_t::primitive_type_t::STRING)
+    {
+        // First read the string into a reused buffer, which terminates it.
+        if(!introspector::read_string(field, introspector::m_number_string))
+        {
+            return false;
+        }
+
+        // Try to parse the string as a value, without throwing.
+        // Strings that are not numbers, or are out of range, are read as NaN.
+        const char* begin = introspector::m_number_string.c_str();
+        char* end = nullptr;
+        errno = 0;
+        value = std::strtod(begin, &end);
+        if(end == begin || errno == ERANGE)
+        {
+            value = std::numeric_limits<double_t>::quiet_NaN();
         }
+
+        return true;
     }
+
+    introspector::m_status = status_t::TYPE_MISMATCH;
+    return false;
 }
\ No newline at end of file
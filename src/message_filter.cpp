@@ -0,0 +1,610 @@
+#include "message_introspection/message_filter.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+using namespace message_introspection;
+
+// ORDERING
+/// \brief Orders two numbers.
+/// \param a The first number.
+/// \param b The second number.
+/// \returns -1 if a is less than b, 0 if they are equal, 1 if a is greater than b, and 2 if either is NaN.
+static int32_t order_numbers(double a, double b)
+{
+    if(a < b)
+    {
+        return -1;
+    }
+    if(a > b)
+    {
+        return 1;
+    }
+    if(a == b)
+    {
+        return 0;
+    }
+    return 2;
+}
+/// \brief Orders two strings by their bytes.
+/// \param a The characters of the first string.
+/// \param a_length The length of the first string.
+/// \param b The characters of the second string.
+/// \param b_length The length of the second string.
+/// \returns -1 if a sorts before b, 0 if they are equal, and 1 if a sorts after b.
+static int32_t order_strings(const uint8_t* a, uint32_t a_length, const uint8_t* b, uint32_t b_length)
+{
+    // Compare the common prefix, and then the lengths.
+    int32_t difference = std::memcmp(a, b, std::min(a_length, b_length));
+    if(difference == 0)
+    {
+        return (a_length < b_length) ? -1 : (a_length > b_length) ? 1 : 0;
+    }
+    return (difference < 0) ? -1 : 1;
+}
+
+// CONSTRUCTORS
+message_filter::message_filter()
+{
+    // Only the filtered fields are read from bag messages, so messages are indexed on the first read.
+    message_filter::m_introspector.set_lazy(true);
+
+    // An empty filter matches every message.
+    message_filter::m_compiled = true;
+    message_filter::m_position = 0;
+    message_filter::m_current_resolution = nullptr;
+}
+message_filter::message_filter(const std::string& expression)
+    : message_filter()
+{
+    message_filter::compile(expression);
+}
+
+// EXPRESSION
+bool message_filter::compile(const std::string& expression)
+{
+    // Discard the previous expression and its resolutions.
+    message_filter::m_expression = expression;
+    message_filter::m_error.clear();
+    message_filter::m_paths.clear();
+    message_filter::m_conditions.clear();
+    message_filter::m_program.clear();
+    message_filter::m_resolutions.clear();
+    message_filter::m_current_resolution = nullptr;
+    message_filter::m_position = 0;
+    message_filter::m_compiled = false;
+
+    // An empty expression matches every message.
+    if(expression.find_first_not_of(" \t\r\n") == std::string::npos)
+    {
+        message_filter::m_compiled = true;
+        message_filter::m_introspector.set_interest({});
+        return true;
+    }
+
+    // Parse the expression, which also emits its program.
+    // The whole expression must be parsed, so anything left over is an error.
+    if(!message_filter::parse_or() || (message_filter::accept("") && message_filter::m_position != expression.size()))
+    {
+        message_filter::fail("unexpected character");
+        message_filter::m_program.clear();
+        return false;
+    }
+
+    // Bag messages only need to be indexed up to the filtered fields.
+    message_filter::m_introspector.set_interest(message_filter::m_paths);
+
+    message_filter::m_compiled = true;
+    return true;
+}
+const std::string& message_filter::expression() const
+{
+    return message_filter::m_expression;
+}
+const std::string& message_filter::error() const
+{
+    return message_filter::m_error;
+}
+const std::vector<std::string>& message_filter::paths() const
+{
+    return message_filter::m_paths;
+}
+
+// PARSING
+bool message_filter::parse_or()
+{
+    if(!message_filter::parse_and())
+    {
+        return false;
+    }
+
+    // Each further term is only evaluated if the terms before it were all FALSE.
+    std::vector<uint32_t> jumps;
+    while(message_filter::accept("||"))
+    {
+        jumps.push_back(static_cast<uint32_t>(message_filter::m_program.size()));
+        message_filter::m_program.push_back({opcode_t::JUMP_IF_TRUE, 0});
+        if(!message_filter::parse_and())
+        {
+            return false;
+        }
+    }
+
+    // A TRUE term jumps past the rest of the disjunction.
+    for(auto jump = jumps.cbegin(); jump != jumps.cend(); ++jump)
+    {
+        message_filter::m_program[*jump].argument = static_cast<uint32_t>(message_filter::m_program.size());
+    }
+    return true;
+}
+bool message_filter::parse_and()
+{
+    if(!message_filter::parse_unary())
+    {
+        return false;
+    }
+
+    // Each further term is only evaluated if the terms before it were all TRUE.
+    std::vector<uint32_t> jumps;
+    while(message_filter::accept("&&"))
+    {
+        jumps.push_back(static_cast<uint32_t>(message_filter::m_program.size()));
+        message_filter::m_program.push_back({opcode_t::JUMP_IF_FALSE, 0});
+        if(!message_filter::parse_unary())
+        {
+            return false;
+        }
+    }
+
+    // A FALSE term jumps past the rest of the conjunction.
+    for(auto jump = jumps.cbegin(); jump != jumps.cend(); ++jump)
+    {
+        message_filter::m_program[*jump].argument = static_cast<uint32_t>(message_filter::m_program.size());
+    }
+    return true;
+}
+bool message_filter::parse_unary()
+{
+    // Negate the following term.
+    if(message_filter::accept("!"))
+    {
+        if(!message_filter::parse_unary())
+        {
+            return false;
+        }
+        message_filter::m_program.push_back({opcode_t::NOT, 0});
+        return true;
+    }
+
+    // Parse a parenthesized expression.
+    if(message_filter::accept("("))
+    {
+        if(!message_filter::parse_or())
+        {
+            return false;
+        }
+        if(!message_filter::accept(")"))
+        {
+            return message_filter::fail("expected ')'");
+        }
+        return true;
+    }
+
+    return message_filter::parse_condition();
+}
+bool message_filter::parse_condition()
+{
+    condition_t condition;
+    if(!message_filter::parse_operand(condition.left))
+    {
+        return false;
+    }
+
+    // Read the comparison operator, checking two character operators first.
+    static const char* tokens[] = {"==", "!=", "<=", ">=", "<", ">"};
+    static const comparison_t comparisons[] = {comparison_t::EQUAL, comparison_t::NOT_EQUAL, comparison_t::LESS_EQUAL, comparison_t::GREATER_EQUAL, comparison_t::LESS, comparison_t::GREATER};
+    condition.comparison = comparison_t::TRUTH;
+    for(uint32_t t = 0; t < 6; ++t)
+    {
+        if(message_filter::accept(tokens[t]))
+        {
+            condition.comparison = comparisons[t];
+            break;
+        }
+    }
+
+    // Without an operator, the operand's truth is tested.
+    if(condition.comparison != comparison_t::TRUTH)
+    {
+        if(!message_filter::parse_operand(condition.right))
+        {
+            return false;
+        }
+
+        // Constant numbers and strings can never be compared with each other.
+        if(condition.left.kind != operand_t::kind_t::PATH && condition.right.kind != operand_t::kind_t::PATH && condition.left.kind != condition.right.kind)
+        {
+            return message_filter::fail("cannot compare a number with a string");
+        }
+
+        // Keep paths on the left, mirroring the operator.
+        if(condition.left.kind != operand_t::kind_t::PATH && condition.right.kind == operand_t::kind_t::PATH)
+        {
+            std::swap(condition.left, condition.right);
+            switch(condition.comparison)
+            {
+                case comparison_t::LESS:
+                {
+                    condition.comparison = comparison_t::GREATER;
+                    break;
+                }
+                case comparison_t::LESS_EQUAL:
+                {
+                    condition.comparison = comparison_t::GREATER_EQUAL;
+                    break;
+                }
+                case comparison_t::GREATER:
+                {
+                    condition.comparison = comparison_t::LESS;
+                    break;
+                }
+                case comparison_t::GREATER_EQUAL:
+                {
+                    condition.comparison = comparison_t::LESS_EQUAL;
+                    break;
+                }
+                default:
+                {
+                    break;
+                }
+            }
+        }
+    }
+
+    // Emit the condition's test.
+    message_filter::m_program.push_back({opcode_t::TEST, static_cast<uint32_t>(message_filter::m_conditions.size())});
+    message_filter::m_conditions.push_back(std::move(condition));
+    return true;
+}
+bool message_filter::parse_operand(operand_t& operand)
+{
+    const std::string& expression = message_filter::m_expression;
+    message_filter::accept("");
+    if(message_filter::m_position == expression.size())
+    {
+        return message_filter::fail("expected an operand");
+    }
+    char next = expression[message_filter::m_position];
+
+    // Parse a quoted string, unescaping backslashes.
+    if(next == '"' || next == '\'')
+    {
+        operand.kind = operand_t::kind_t::STRING;
+        size_t position = message_filter::m_position + 1;
+        for(; position < expression.size() && expression[position] != next; ++position)
+        {
+            if(expression[position] == '\\' && position + 1 < expression.size())
+            {
+                ++position;
+            }
+            operand.text.push_back(expression[position]);
+        }
+        if(position == expression.size())
+        {
+            return message_filter::fail("unterminated string");
+        }
+        message_filter::m_position = position + 1;
+        return true;
+    }
+
+    // Parse a number.
+    if(std::isdigit(static_cast<unsigned char>(next)) || next == '-' || next == '+' || next == '.')
+    {
+        const char* start = expression.c_str() + message_filter::m_position;
+        char* end;
+        operand.kind = operand_t::kind_t::NUMBER;
+        operand.number = std::strtod(start, &end);
+        if(end == start)
+        {
+            return message_filter::fail("invalid number");
+        }
+        message_filter::m_position += end - start;
+        return true;
+    }
+
+    // Parse a path, which may contain field names, periods and array indices.
+    if(std::isalpha(static_cast<unsigned char>(next)) || next == '_')
+    {
+        size_t position = message_filter::m_position;
+        while(position < expression.size() && (std::isalnum(static_cast<unsigned char>(expression[position])) || std::strchr("_.[]", expression[position]) != nullptr))
+        {
+            ++position;
+        }
+        std::string path = expression.substr(message_filter::m_position, position - message_filter::m_position);
+        message_filter::m_position = position;
+
+        // Booleans are the numbers one and zero.
+        if(path == "true" || path == "false")
+        {
+            operand.kind = operand_t::kind_t::NUMBER;
+            operand.number = (path == "true") ? 1.0 : 0.0;
+            return true;
+        }
+
+        // Paths that appear more than once share a handle.
+        operand.kind = operand_t::kind_t::PATH;
+        operand.path = static_cast<uint32_t>(std::find(message_filter::m_paths.begin(), message_filter::m_paths.end(), path) - message_filter::m_paths.begin());
+        if(operand.path == message_filter::m_paths.size())
+        {
+            message_filter::m_paths.push_back(path);
+        }
+        return true;
+    }
+
+    return message_filter::fail("expected an operand");
+}
+bool message_filter::accept(const char* token)
+{
+    const std::string& expression = message_filter::m_expression;
+
+    // Skip whitespace.
+    while(message_filter::m_position < expression.size() && std::isspace(static_cast<unsigned char>(expression[message_filter::m_position])))
+    {
+        ++message_filter::m_position;
+    }
+
+    // Consume the token if it is next.
+    size_t length = std::strlen(token);
+    if(expression.compare(message_filter::m_position, length, token) != 0)
+    {
+        return false;
+    }
+    message_filter::m_position += length;
+    return true;
+}
+bool message_filter::fail(const std::string& message)
+{
+    // Keep the first error, which is closest to the problem.
+    if(message_filter::m_error.empty())
+    {
+        message_filter::m_error = message + " at position " + std::to_string(message_filter::m_position);
+    }
+    return false;
+}
+
+// RESOLUTION
+const message_filter::resolution_t* message_filter::resolve(introspector& introspector)
+{
+    // Consecutive messages usually have the same type, which is still current if one of its handles is.
+    const resolution_t* current = message_filter::m_current_resolution;
+    if(current != nullptr && current->probe < current->handles.size() && !introspector.is_stale(current->handles[current->probe]))
+    {
+        return current;
+    }
+
+    // Otherwise find the resolution of the introspector's message type.
+    std::shared_ptr<const schema_t> schema = introspector.schema();
+    if(schema == nullptr)
+    {
+        return nullptr;
+    }
+    auto entry = message_filter::m_resolutions.find(schema->id());
+    if(entry == message_filter::m_resolutions.end())
+    {
+        // Resolve each path, leaving the handles of paths that do not exist in the type unresolved.
+        resolution_t resolution;
+        resolution.handles.resize(message_filter::m_paths.size());
+        resolution.probe = static_cast<uint32_t>(message_filter::m_paths.size());
+        for(uint32_t p = 0; p < message_filter::m_paths.size(); ++p)
+        {
+            if(introspector.get_handle(message_filter::m_paths[p], resolution.handles[p]) && resolution.probe == message_filter::m_paths.size())
+            {
+                resolution.probe = p;
+            }
+        }
+
+        // Check which conditions can be evaluated in the type.
+        // A path is a string or a number, and can only be compared with another operand of the same kind.
+        for(auto condition = message_filter::m_conditions.cbegin(); condition != message_filter::m_conditions.cend(); ++condition)
+        {
+            const operand_t* operands[2] = {&(condition->left), &(condition->right)};
+            uint32_t n_operands = (condition->comparison == comparison_t::TRUTH) ? 1 : 2;
+            bool comparable = true;
+            bool is_string = false;
+            for(uint32_t o = 0; o < n_operands; ++o)
+            {
+                bool operand_string = operands[o]->kind == operand_t::kind_t::STRING;
+                if(operands[o]->kind == operand_t::kind_t::PATH)
+                {
+                    const field_handle_t& handle = resolution.handles[operands[o]->path];
+                    comparable = comparable && handle.is_resolved();
+                    operand_string = handle.primitive_type() == definition_t::primitive_type_t::STRING;
+                }
+                comparable = comparable && (o == 0 || operand_string == is_string);
+                is_string = operand_string;
+            }
+            resolution.comparable.push_back(comparable ? 1 : 0);
+            resolution.strings.push_back(is_string ? 1 : 0);
+        }
+
+        entry = message_filter::m_resolutions.emplace(schema->id(), std::move(resolution)).first;
+    }
+
+    // Remember the type for the next message.
+    message_filter::m_current_resolution = &(entry->second);
+
+    return message_filter::m_current_resolution;
+}
+
+// EVALUATE
+bool message_filter::matches(introspector& introspector)
+{
+    // Invalid expressions match nothing, and empty expressions match everything.
+    if(!message_filter::m_compiled)
+    {
+        return false;
+    }
+    if(message_filter::m_program.empty())
+    {
+        return true;
+    }
+
+    // Get the conditions of the message's type.
+    const resolution_t* resolution = message_filter::resolve(introspector);
+    if(resolution == nullptr)
+    {
+        return false;
+    }
+
+    // Run the program, which jumps past the conditions that can no longer change the result.
+    bool result = false;
+    uint32_t i = 0;
+    uint32_t n_instructions = static_cast<uint32_t>(message_filter::m_program.size());
+    while(i < n_instructions)
+    {
+        const instruction_t& instruction = message_filter::m_program[i];
+        switch(instruction.opcode)
+        {
+            case opcode_t::TEST:
+            {
+                result = message_filter::test(introspector, *resolution, instruction.argument);
+                ++i;
+                break;
+            }
+            case opcode_t::NOT:
+            {
+                result = !result;
+                ++i;
+                break;
+            }
+            case opcode_t::JUMP_IF_FALSE:
+            {
+                i = result ? i + 1 : instruction.argument;
+                break;
+            }
+            case opcode_t::JUMP_IF_TRUE:
+            {
+                i = result ? instruction.argument : i + 1;
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+bool message_filter::matches(const rosbag::MessageInstance& message)
+{
+    // Read the message, which reuses the introspector's buffer and cached schema.
+    message_filter::m_introspector.new_message(message);
+
+    return message_filter::matches(message_filter::m_introspector);
+}
+
+// EVALUATION
+bool message_filter::test(const introspector& introspector, const resolution_t& resolution, uint32_t c) const
+{
+    // Conditions whose fields are missing or whose operands cannot be compared are FALSE.
+    if(resolution.comparable[c] == 0)
+    {
+        return false;
+    }
+    const condition_t& condition = message_filter::m_conditions[c];
+    const operand_t* operands[2] = {&(condition.left), &(condition.right)};
+    uint32_t n_operands = (condition.comparison == comparison_t::TRUTH) ? 1 : 2;
+
+    // Compare strings in place within the message.
+    if(resolution.strings[c] != 0)
+    {
+        const uint8_t* characters[2];
+        uint32_t lengths[2];
+        for(uint32_t o = 0; o < n_operands; ++o)
+        {
+            if(operands[o]->kind == operand_t::kind_t::PATH)
+            {
+                span_t<char> value;
+                if(!introspector.get_string(resolution.handles[operands[o]->path], value))
+                {
+                    return false;
+                }
+                characters[o] = value.bytes();
+                lengths[o] = value.size();
+            }
+            else
+            {
+                characters[o] = reinterpret_cast<const uint8_t*>(operands[o]->text.data());
+                lengths[o] = static_cast<uint32_t>(operands[o]->text.size());
+            }
+        }
+        if(condition.comparison == comparison_t::TRUTH)
+        {
+            return lengths[0] != 0;
+        }
+
+        // Strings of different lengths are unequal without comparing their characters.
+        if(lengths[0] != lengths[1] && (condition.comparison == comparison_t::EQUAL || condition.comparison == comparison_t::NOT_EQUAL))
+        {
+            return condition.comparison == comparison_t::NOT_EQUAL;
+        }
+        return message_filter::holds(condition.comparison, order_strings(characters[0], lengths[0], characters[1], lengths[1]));
+    }
+
+    // Compare numbers.
+    double numbers[2];
+    for(uint32_t o = 0; o < n_operands; ++o)
+    {
+        if(operands[o]->kind == operand_t::kind_t::PATH)
+        {
+            if(!introspector.get_number(resolution.handles[operands[o]->path], numbers[o]))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            numbers[o] = operands[o]->number;
+        }
+    }
+    if(condition.comparison == comparison_t::TRUTH)
+    {
+        return numbers[0] != 0.0;
+    }
+    return message_filter::holds(condition.comparison, order_numbers(numbers[0], numbers[1]));
+}
+bool message_filter::holds(comparison_t comparison, int32_t order)
+{
+    // Unordered operands, such as NaN, are only unequal.
+    switch(comparison)
+    {
+        case comparison_t::EQUAL:
+        {
+            return order == 0;
+        }
+        case comparison_t::NOT_EQUAL:
+        {
+            return order != 0;
+        }
+        case comparison_t::LESS:
+        {
+            return order == -1;
+        }
+        case comparison_t::LESS_EQUAL:
+        {
+            return order == -1 || order == 0;
+        }
+        case comparison_t::GREATER:
+        {
+            return order == 1;
+        }
+        case comparison_t::GREATER_EQUAL:
+        {
+            return order == 0 || order == 1;
+        }
+        case comparison_t::TRUTH:
+        {
+            break;
+        }
+    }
+    return false;
+}
\ No newline at end of file
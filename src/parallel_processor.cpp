@@ -0,0 +1,205 @@
+#include "message_introspection/parallel_processor.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <algorithm>
+
+using namespace message_introspection;
+
+// CONSTRUCTORS
+parallel_processor::parallel_processor(uint32_t n_threads, uint32_t window)
+{
+    // Use one thread per core by default.
+    if(n_threads == 0)
+    {
+        n_threads = std::max(1U, std::thread::hardware_concurrency());
+    }
+    parallel_processor::m_n_threads = n_threads;
+
+    // Keep enough messages in flight that workers rarely wait on the slowest message.
+    if(window == 0)
+    {
+        window = 16 * n_threads;
+    }
+    parallel_processor::m_window = std::max(window, n_threads);
+}
+
+// PROPERTIES
+uint32_t parallel_processor::n_threads() const
+{
+    return parallel_processor::m_n_threads;
+}
+uint32_t parallel_processor::window() const
+{
+    return parallel_processor::m_window;
+}
+
+// RUN
+uint64_t parallel_processor::run(rosbag::View& view, const std::function<void(introspector&, const message_info_t&, uint32_t)>& decode, const std::function<void(const message_info_t&, uint32_t)>& consume)
+{
+    // Set up the window's slots.
+    // Slots are kept between runs, so their buffers are reused.
+    parallel_processor::m_slots.resize(parallel_processor::m_window);
+    for(auto slot = parallel_processor::m_slots.begin(); slot != parallel_processor::m_slots.end(); ++slot)
+    {
+        slot->decoded = false;
+    }
+
+    // Set up the state shared with the workers, which is protected by the mutex.
+    std::mutex mutex;
+    // Signals workers when a message is loaded, or when there are no more messages.
+    std::condition_variable loaded_condition;
+    // Signals the calling thread when a message is decoded.
+    std::condition_variable decoded_condition;
+    // The number of messages loaded into slots.
+    uint64_t n_loaded = 0;
+    // The number of messages claimed by workers.
+    uint64_t n_claimed = 0;
+    // Indicates that no more messages will be loaded.
+    bool finished = false;
+    // The first exception thrown by a decoder.
+    std::exception_ptr error;
+
+    // Start the workers.
+    std::vector<std::thread> workers;
+    for(uint32_t w = 0; w < parallel_processor::m_n_threads; ++w)
+    {
+        workers.emplace_back([&]()
+        {
+            // Each worker has its own introspector, which shares schemas with the others through the registry.
+            introspector message;
+            message.set_lazy(true);
+
+            while(true)
+            {
+                // Claim the next loaded message.
+                uint64_t sequence;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    loaded_condition.wait(lock, [&](){return n_claimed < n_loaded || finished;});
+                    if(n_claimed == n_loaded)
+                    {
+                        return;
+                    }
+                    sequence = n_claimed++;
+                }
+
+                // Decode the message, reading directly from the slot's bytes.
+                uint32_t index = static_cast<uint32_t>(sequence % parallel_processor::m_window);
+                slot_t& slot = parallel_processor::m_slots[index];
+                std::exception_ptr decode_error;
+                try
+                {
+                    message.new_message(slot.bytes.data(), slot.length, *(slot.md5), *(slot.type), *(slot.definition), true);
+                    decode(message, slot.info, index);
+                }
+                catch(...)
+                {
+                    decode_error = std::current_exception();
+                }
+
+                // Hand the slot back to the calling thread.
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    slot.decoded = true;
+                    if(decode_error && !error)
+                    {
+                        error = decode_error;
+                    }
+                }
+                decoded_condition.notify_all();
+            }
+        });
+    }
+
+    // Consumes the oldest message in flight once it has been decoded.
+    uint64_t n_consumed = 0;
+    auto consume_next = [&]()
+    {
+        // Wait for the message to be decoded.
+        slot_t& slot = parallel_processor::m_slots[n_consumed % parallel_processor::m_window];
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            decoded_condition.wait(lock, [&](){return slot.decoded;});
+            slot.decoded = false;
+            if(error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+
+        // Pass its result to the consumer.
+        consume(slot.info, static_cast<uint32_t>(n_consumed % parallel_processor::m_window));
+        ++n_consumed;
+    };
+
+    // Stops the workers once they have finished the messages already loaded.
+    auto stop_workers = [&]()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            finished = true;
+        }
+        loaded_condition.notify_all();
+        for(auto worker = workers.begin(); worker != workers.end(); ++worker)
+        {
+            worker->join();
+        }
+    };
+
+    try
+    {
+        // Read messages from the bag on this thread, since bags do not support concurrent reads.
+        for(auto instance = view.begin(); instance != view.end(); ++instance)
+        {
+            // Free the message's slot by consuming the message that used it last.
+            if(n_loaded - n_consumed == parallel_processor::m_window)
+            {
+                consume_next();
+            }
+
+            // Copy the message's bytes into its slot.
+            // No worker accesses the slot until the message is marked as loaded.
+            slot_t& slot = parallel_processor::m_slots[n_loaded % parallel_processor::m_window];
+            const rosbag::MessageInstance& instance_ref = *instance;
+            slot.length = instance_ref.size();
+            if(slot.bytes.size() < slot.length)
+            {
+                slot.bytes.resize(slot.length);
+            }
+            ros::serialization::OStream stream(slot.bytes.data(), slot.length);
+            instance_ref.write(stream);
+            slot.md5 = &(instance_ref.getMD5Sum());
+            slot.type = &(instance_ref.getDataType());
+            slot.definition = &(instance_ref.getMessageDefinition());
+            slot.info.sequence = n_loaded;
+            slot.info.topic = &(instance_ref.getTopic());
+            slot.info.time = instance_ref.getTime();
+
+            // Mark the message as loaded and wake a worker.
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ++n_loaded;
+            }
+            loaded_condition.notify_one();
+        }
+
+        // Consume the messages still in flight.
+        while(n_consumed < n_loaded)
+        {
+            consume_next();
+        }
+    }
+    catch(...)
+    {
+        // Workers must be joined before the exception leaves this method.
+        stop_workers();
+        throw;
+    }
+
+    stop_workers();
+
+    return n_consumed;
+}
\ No newline at end of file
@@ -0,0 +1,165 @@
+#include "message_introspection/prefetcher.h"
+
+#include <algorithm>
+
+using namespace message_introspection;
+
+// CONSTRUCTORS
+prefetcher::prefetcher(rosbag::View& view, uint32_t capacity)
+    : m_view(view)
+{
+    // Set up the queue, keeping an extra slot for the message being read.
+    prefetcher::m_slots.resize(std::max(capacity, 1U) + 1);
+    prefetcher::m_n_read = 0;
+    prefetcher::m_n_taken = 0;
+    prefetcher::m_finished = false;
+    prefetcher::m_stop = false;
+
+    // Initialize statistics.
+    prefetcher::m_idle_time = std::chrono::nanoseconds::zero();
+    prefetcher::m_n_stalls = 0;
+
+    // Start reading the view.
+    prefetcher::m_reader = std::thread(&prefetcher::read_view, this);
+}
+prefetcher::~prefetcher()
+{
+    // Stop the reader, which may be waiting for a free slot.
+    {
+        std::lock_guard<std::mutex> lock(prefetcher::m_mutex);
+        prefetcher::m_stop = true;
+    }
+    prefetcher::m_freed_condition.notify_one();
+    prefetcher::m_reader.join();
+}
+
+// MESSAGES
+bool prefetcher::next(introspector& introspector)
+{
+    uint64_t sequence;
+    {
+        std::unique_lock<std::mutex> lock(prefetcher::m_mutex);
+
+        // Wait for the reader if no message is ready, tracking the time spent idle.
+        if(prefetcher::m_n_taken == prefetcher::m_n_read && !prefetcher::m_finished)
+        {
+            auto start = std::chrono::steady_clock::now();
+            prefetcher::m_read_condition.wait(lock, [this](){return prefetcher::m_n_taken < prefetcher::m_n_read || prefetcher::m_finished;});
+            prefetcher::m_idle_time += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+            ++prefetcher::m_n_stalls;
+        }
+
+        // Messages read before an error are still delivered.
+        if(prefetcher::m_n_taken == prefetcher::m_n_read)
+        {
+            if(prefetcher::m_error)
+            {
+                std::rethrow_exception(prefetcher::m_error);
+            }
+            return false;
+        }
+        sequence = prefetcher::m_n_taken++;
+    }
+
+    // Taking a message releases the previous message's slot to the reader.
+    prefetcher::m_freed_condition.notify_one();
+
+    // Pass the message to the introspector, which reads directly from the slot.
+    const slot_t& slot = prefetcher::m_slots[sequence % prefetcher::m_slots.size()];
+    introspector.new_message(slot.bytes.data(), slot.length, *(slot.md5), *(slot.type), *(slot.definition), true);
+
+    return true;
+}
+const std::string& prefetcher::topic() const
+{
+    // Before the first message is taken, there is no current message.
+    static const std::string empty_topic;
+    if(prefetcher::m_n_taken == 0)
+    {
+        return empty_topic;
+    }
+
+    return *(prefetcher::m_slots[(prefetcher::m_n_taken - 1) % prefetcher::m_slots.size()].topic);
+}
+ros::Time prefetcher::time() const
+{
+    // Before the first message is taken, there is no current message.
+    if(prefetcher::m_n_taken == 0)
+    {
+        return ros::Time();
+    }
+
+    return prefetcher::m_slots[(prefetcher::m_n_taken - 1) % prefetcher::m_slots.size()].time;
+}
+
+// READER
+void prefetcher::read_view()
+{
+    try
+    {
+        for(auto instance = prefetcher::m_view.begin(); instance != prefetcher::m_view.end(); ++instance)
+        {
+            // Wait for a free slot.
+            // The slot of the message most recently taken is still in use, so it is not free.
+            uint64_t sequence;
+            {
+                std::unique_lock<std::mutex> lock(prefetcher::m_mutex);
+                prefetcher::m_freed_condition.wait(lock, [this](){return prefetcher::m_n_read - prefetcher::m_n_taken + 1 < prefetcher::m_slots.size() || prefetcher::m_stop;});
+                if(prefetcher::m_stop)
+                {
+                    return;
+                }
+                sequence = prefetcher::m_n_read;
+            }
+
+            // Copy the message's bytes into the slot.
+            // The consumer does not access the slot until the message is marked as read.
+            slot_t& slot = prefetcher::m_slots[sequence % prefetcher::m_slots.size()];
+            const rosbag::MessageInstance& message = *instance;
+            slot.length = message.size();
+            if(slot.bytes.size() < slot.length)
+            {
+                slot.bytes.resize(slot.length);
+            }
+            ros::serialization::OStream stream(slot.bytes.data(), slot.length);
+            message.write(stream);
+            slot.md5 = &(message.getMD5Sum());
+            slot.type = &(message.getDataType());
+            slot.definition = &(message.getMessageDefinition());
+            slot.topic = &(message.getTopic());
+            slot.time = message.getTime();
+
+            // Mark the message as read.
+            {
+                std::lock_guard<std::mutex> lock(prefetcher::m_mutex);
+                ++prefetcher::m_n_read;
+            }
+            prefetcher::m_read_condition.notify_one();
+        }
+    }
+    catch(...)
+    {
+        // Pass the exception to the introspection thread.
+        std::lock_guard<std::mutex> lock(prefetcher::m_mutex);
+        prefetcher::m_error = std::current_exception();
+    }
+
+    // Signal the end of the view.
+    {
+        std::lock_guard<std::mutex> lock(prefetcher::m_mutex);
+        prefetcher::m_finished = true;
+    }
+    prefetcher::m_read_condition.notify_one();
+}
+
+// STATISTICS
+std::chrono::nanoseconds prefetcher::idle_time() const
+{
+    std::lock_guard<std::mutex> lock(prefetcher::m_mutex);
+    return prefetcher::m_idle_time;
+}
+uint64_t prefetcher::n_stalls() const
+{
+    std::lock_guard<std::mutex> lock(prefetcher::m_mutex);
+    return prefetcher::m_n_stalls;
+}
\ No newline at end of file
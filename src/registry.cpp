@@ -0,0 +1,51 @@
+#include "message_introspection/registry.h"
+
+#include <mutex>
+#include <unordered_map>
+
+using namespace message_introspection;
+
+// STORAGE
+/// \brief Protects the registered schemas.
+static std::mutex s_mutex;
+/// \brief Stores the registered schemas, keyed by MD5 hash.
+static std::unordered_map<std::string, std::shared_ptr<const schema_t>> s_schemas;
+
+// SCHEMAS
+std::shared_ptr<const schema_t> registry::get_schema(const std::string& md5, const std::string& type, const std::string& definition)
+{
+    // Check if the message type is already registered.
+    auto schema = registry::find_schema(md5);
+    if(schema)
+    {
+        return schema;
+    }
+
+    // Parse the definition outside of the lock.
+    schema = std::make_shared<const schema_t>(md5, type, definition);
+
+    // Register the schema, unless another thread registered the same type in the meantime.
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return s_schemas.emplace(md5, schema).first->second;
+}
+std::shared_ptr<const schema_t> registry::find_schema(const std::string& md5)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    auto schema = s_schemas.find(md5);
+    if(schema == s_schemas.end())
+    {
+        return nullptr;
+    }
+    return schema->second;
+}
+size_t registry::size()
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return s_schemas.size();
+}
+void registry::clear()
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_schemas.clear();
+}
\ No newline at end of file
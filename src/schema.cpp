@@ -0,0 +1,571 @@
+#include "message_introspection/schema.h"
+
+#include <atomic>
+#include <cstring>
+#include <sstream>
+
+using namespace message_introspection;
+
+// SCHEMA IDS
+/// \brief Stores the last ID assigned to any schema.
+/// \details IDs are unique across the process so handles can never match another schema.
+static std::atomic<uint64_t> s_last_id(0);
+
+// CONSTRUCTORS
+schema_t::schema_t(const std::string& md5, const std::string& type, const std::string& definition)
+{
+    // Store properties.
+    schema_t::m_md5 = md5;
+    schema_t::m_type = type;
+
+    // Extract message component types.
+    schema_t::parse_components(type, definition);
+
+    // Add the top level message's node, and let recursion handle the rest.
+    schema_t::m_nodes.push_back(schema_t::create_node(definition_t(type, "", ""), 0));
+    schema_t::add_fields(0);
+
+    // Lay out the nodes, which are positioned as the decoder plan is compiled.
+    schema_t::m_layout.resize(schema_t::m_nodes.size(), {-1, 0, 0, 0});
+
+    // Compile the definition tree into a decoder plan, noting where each top level field starts.
+    scope_t scope = {-1, 0};
+    uint32_t run_size = 0;
+    const node_t& message = schema_t::m_nodes[0];
+    for(uint32_t field = message.first_field; field < message.first_field + message.n_fields; ++field)
+    {
+        schema_t::m_prefixes.push_back({static_cast<uint32_t>(schema_t::m_plan.size()), run_size});
+        schema_t::compile_definition(field, scope, run_size);
+    }
+    schema_t::flush_run(run_size);
+    schema_t::m_prefixes.push_back({static_cast<uint32_t>(schema_t::m_plan.size()), 0});
+    schema_t::m_layout[0].anchors = scope.anchors;
+
+    // Assign a new ID, which handles are resolved against.
+    schema_t::m_id = ++s_last_id;
+}
+
+// PROPERTIES
+const std::string& schema_t::md5() const
+{
+    return schema_t::m_md5;
+}
+const std::string& schema_t::type() const
+{
+    return schema_t::m_type;
+}
+uint64_t schema_t::id() const
+{
+    return schema_t::m_id;
+}
+const definition_tree_t& schema_t::definition_tree() const
+{
+    // Build and index the definition tree the first time it is requested.
+    std::call_once(schema_t::m_definition_tree_built, [this]()
+    {
+        schema_t::build_definition_tree("", schema_t::m_definition_tree, 0);
+        schema_t::m_definition_tree.index_fields();
+    });
+    return schema_t::m_definition_tree;
+}
+uint32_t schema_t::n_nodes() const
+{
+    return static_cast<uint32_t>(schema_t::m_nodes.size());
+}
+const schema_t::node_t& schema_t::node(uint32_t node) const
+{
+    return schema_t::m_nodes.at(node);
+}
+
+// PRINTING
+std::string schema_t::print_components() const
+{
+    // Create output stream.
+    std::stringstream output;
+
+    // Iterate over component definitions.
+    for(auto component = schema_t::m_component_definitions.begin(); component != schema_t::m_component_definitions.end(); ++component)
+    {
+        // Output component overall type.
+        output << component->first << std::endl;;
+
+        // Output component fields.
+        auto& fields = component->second;
+        for(auto field = fields.begin(); field != fields.end(); ++field)
+        {
+            output << "\tname = " << field->name() << " type = " << field->type() << " array = " << field->array() << std::endl;
+        }
+    }
+
+    return output.str();
+}
+std::string schema_t::print_definition_tree() const
+{
+    return schema_t::definition_tree().print();
+}
+
+// COMPONENTS
+void schema_t::parse_components(const std::string& message_type, const std::string& definition)
+{
+    // Add top-level message to definition and set it as the current workspace.
+    auto* fields_workspace = &schema_t::m_component_definitions[message_type];
+
+    // Scan the definition line by line in place, without copying it.
+    // The token strings are reused for every line.
+    std::string type;
+    std::string array;
+    std::string name;
+    const char* line_begin = definition.data();
+    const char* definition_end = line_begin + definition.size();
+    while(line_begin < definition_end)
+    {
+        // Find the end of the line, and the start of the next.
+        const char* line_end = static_cast<const char*>(std::memchr(line_begin, '\n', definition_end - line_begin));
+        if(line_end == nullptr)
+        {
+            line_end = definition_end;
+        }
+        const char* next_line = line_end + 1;
+
+        // Remove any comments from the line before tokenizing.
+        const char* comment = static_cast<const char*>(std::memchr(line_begin, '#', line_end - line_begin));
+        if(comment != nullptr)
+        {
+            line_end = comment;
+        }
+
+        // Check if line is an equals separator line, or defining a constant
+        if(std::memchr(line_begin, '=', line_end - line_begin) != nullptr)
+        {
+            // Skip this line.
+            line_begin = next_line;
+            continue;
+        }
+
+        // Find the first two tokens of the line.
+        const char* first_begin = schema_t::skip_whitespace(line_begin, line_end);
+        const char* first_end = schema_t::skip_token(first_begin, line_end);
+        const char* second_begin = schema_t::skip_whitespace(first_end, line_end);
+        const char* second_end = schema_t::skip_token(second_begin, line_end);
+        line_begin = next_line;
+
+        // Check if tokens exist.
+        if(second_begin == second_end)
+        {
+            continue;
+        }
+
+        // Check if first token is a new sub-message designator.
+        if(first_end - first_begin == 4 && std::memcmp(first_begin, "MSG:", 4) == 0)
+        {
+            // Initiate new sub-message and switch workspace to it.
+            name.assign(second_begin, second_end);
+            fields_workspace = &schema_t::m_component_definitions[name];
+        }
+        else
+        {
+            // Check if type is an array.
+            const char* array_begin = static_cast<const char*>(std::memchr(first_begin, '[', first_end - first_begin));
+            if(array_begin == nullptr)
+            {
+                array_begin = first_end;
+            }
+            type.assign(first_begin, array_begin);
+            array.assign(array_begin, first_end);
+            name.assign(second_begin, second_end);
+
+            // Add a new component definition to the fields workspace.
+            fields_workspace->emplace_back(type, array, name);
+        }
+    }
+
+    // Index the components by their short names, so that unqualified types can be found without a search.
+    // Short names that are shared by several packages are ambiguous, and are not indexed.
+    std::unordered_map<std::string, const std::string*> short_names;
+    for(auto component = schema_t::m_component_definitions.cbegin(); component != schema_t::m_component_definitions.cend(); ++component)
+    {
+        auto separator = component->first.find_last_of('/');
+        if(separator == std::string::npos)
+        {
+            continue;
+        }
+        auto entry = short_names.emplace(component->first.substr(separator + 1), &(component->first));
+        if(!entry.second)
+        {
+            entry.first->second = nullptr;
+        }
+    }
+
+    // Resolve each field's type to the exact name of its component.
+    std::string qualified_type;
+    for(auto component = schema_t::m_component_definitions.begin(); component != schema_t::m_component_definitions.end(); ++component)
+    {
+        // Unqualified types refer to the package of the message that contains them.
+        auto separator = component->first.find_last_of('/');
+        for(auto field = component->second.begin(); field != component->second.end(); ++field)
+        {
+            // Check if field is a primitive field, or its type is already an exact component name.
+            if(field->is_primitive() || schema_t::m_component_definitions.count(field->type()) != 0)
+            {
+                continue;
+            }
+
+            // Qualify the type, following the ROS message naming rules.
+            // Header is the only type that always refers to another package.
+            const std::string& field_type = field->type();
+            if(field_type.compare("Header") == 0)
+            {
+                qualified_type = "std_msgs/Header";
+            }
+            else if(separator != std::string::npos && field_type.find_first_of('/') == std::string::npos)
+            {
+                qualified_type.assign(component->first, 0, separator + 1);
+                qualified_type += field_type;
+            }
+            else
+            {
+                qualified_type.clear();
+            }
+            if(!qualified_type.empty() && schema_t::m_component_definitions.count(qualified_type) != 0)
+            {
+                field->update_type(qualified_type);
+                continue;
+            }
+
+            // Otherwise, fall back to a component with the same short name, if there is only one.
+            auto short_name = short_names.find(field_type.substr(field_type.find_last_of('/') + 1));
+            if(short_name != short_names.end() && short_name->second != nullptr)
+            {
+                field->update_type(*(short_name->second));
+            }
+        }
+    }
+}
+const char* schema_t::skip_whitespace(const char* begin, const char* end)
+{
+    while(begin < end && (*begin == ' ' || *begin == '\t' || *begin == '\r'))
+    {
+        ++begin;
+    }
+    return begin;
+}
+const char* schema_t::skip_token(const char* begin, const char* end)
+{
+    while(begin < end && *begin != ' ' && *begin != '\t' && *begin != '\r')
+    {
+        ++begin;
+    }
+    return begin;
+}
+
+// NODES
+const std::string* schema_t::intern(const std::string& string)
+{
+    return &(*(schema_t::m_strings.insert(string).first));
+}
+schema_t::node_t schema_t::create_node(const definition_t& definition, uint32_t parent)
+{
+    node_t node;
+    node.name = schema_t::intern(definition.name());
+    node.type = schema_t::intern(definition.type());
+    node.primitive_type = definition.primitive_type();
+    node.array_type = definition.array_type();
+    node.array_length = definition.array_length();
+    node.size = definition.size();
+    node.fixed_size = definition.is_fixed_size();
+    node.serialized_size = definition.serialized_size();
+    node.parent = parent;
+    node.first_field = 0;
+    node.n_fields = 0;
+    return node;
+}
+void schema_t::add_fields(uint32_t node)
+{
+    // Primitives have no fields.
+    if(schema_t::m_nodes[node].is_primitive())
+    {
+        return;
+    }
+
+    // Get the fields of this node from the component map.
+    // Types without a component have no fields.
+    auto component = schema_t::m_component_definitions.find(*(schema_t::m_nodes[node].type));
+    if(component == schema_t::m_component_definitions.end())
+    {
+        schema_t::m_nodes[node].fixed_size = true;
+        schema_t::m_nodes[node].serialized_size = 0;
+        return;
+    }
+    const std::vector<definition_t>& fields = component->second;
+
+    // Add the node's fields contiguously, so a field's node is found from its index.
+    uint32_t first_field = static_cast<uint32_t>(schema_t::m_nodes.size());
+    for(auto field = fields.cbegin(); field != fields.cend(); ++field)
+    {
+        schema_t::m_nodes.push_back(schema_t::create_node(*field, node));
+    }
+    schema_t::m_nodes[node].first_field = first_field;
+    schema_t::m_nodes[node].n_fields = static_cast<uint32_t>(fields.size());
+
+    // Initialize the node's size to 0 so it can be summed over the fields.
+    uint32_t total_size = 0;
+    // The node only has a fixed serialized size if all of its fields do.
+    bool fixed_size = true;
+    uint32_t serialized_size = 0;
+
+    // Add the fields of each field recursively, then add their computed sizes to the node's size.
+    // Nodes are referred to by index, since adding nodes may move them.
+    for(uint32_t i = 0; i < fields.size(); ++i)
+    {
+        schema_t::add_fields(first_field + i);
+
+        const node_t& field = schema_t::m_nodes[first_field + i];
+        total_size += field.size;
+        // Variable length arrays and fields containing strings change size between messages.
+        fixed_size = fixed_size && field.fixed_size && field.array_type != definition_t::array_type_t::VARIABLE_LENGTH;
+        if(fixed_size)
+        {
+            uint32_t instances = field.is_array() ? field.array_length : 1;
+            serialized_size += instances * field.serialized_size;
+        }
+    }
+
+    // Update the node's size.
+    node_t& parent = schema_t::m_nodes[node];
+    parent.size = total_size;
+    parent.fixed_size = fixed_size;
+    parent.serialized_size = fixed_size ? serialized_size : 0;
+}
+
+// DEFINITION
+void schema_t::build_definition_tree(const std::string& parent_path, definition_tree_t& definition_tree, uint32_t node) const
+{
+    const node_t& definition_node = schema_t::m_nodes[node];
+
+    // Recreate the node's array specifier.
+    std::string array;
+    if(definition_node.array_type == definition_t::array_type_t::VARIABLE_LENGTH)
+    {
+        array = "[]";
+    }
+    else if(definition_node.array_type == definition_t::array_type_t::FIXED_LENGTH)
+    {
+        array = "[" + std::to_string(definition_node.array_length) + "]";
+    }
+
+    // Set the tree's definition.
+    definition_tree.definition = definition_t(*(definition_node.type), array, *(definition_node.name));
+    definition_tree.definition.update_parent_path(parent_path);
+    if(!definition_node.is_primitive())
+    {
+        definition_tree.definition.update_size(definition_node.size);
+        definition_tree.definition.update_serialized_size(definition_node.fixed_size, definition_node.serialized_size);
+    }
+
+    // Add each field recursively and in place.
+    definition_tree.fields.resize(definition_node.n_fields);
+    for(uint32_t i = 0; i < definition_node.n_fields; ++i)
+    {
+        schema_t::build_definition_tree(definition_tree.definition.path(), definition_tree.fields[i], definition_node.first_field + i);
+    }
+}
+
+// LAYOUT
+void schema_t::layout_instance(uint32_t node)
+{
+    // Fields of a fixed size instance follow each other at fixed offsets.
+    const node_t& instance = schema_t::m_nodes[node];
+    uint32_t offset = 0;
+    for(uint32_t field = instance.first_field; field < instance.first_field + instance.n_fields; ++field)
+    {
+        schema_t::m_layout[field].offset = offset;
+        schema_t::layout_instance(field);
+
+        const node_t& field_node = schema_t::m_nodes[field];
+        uint32_t instances = field_node.is_array() ? field_node.array_length : 1;
+        offset += instances * field_node.serialized_size;
+    }
+}
+bool schema_t::is_folded(const node_t& node)
+{
+    return node.fixed_size && node.array_type == definition_t::array_type_t::FIXED_LENGTH;
+}
+
+// PLAN
+void schema_t::compile_fields(uint32_t node, scope_t& scope, uint32_t& run_size)
+{
+    const node_t& parent = schema_t::m_nodes[node];
+    for(uint32_t field = parent.first_field; field < parent.first_field + parent.n_fields; ++field)
+    {
+        schema_t::compile_definition(field, scope, run_size);
+    }
+}
+void schema_t::compile_definition(uint32_t node, scope_t& scope, uint32_t& run_size)
+{
+    const node_t& definition = schema_t::m_nodes[node];
+
+    // The node starts at the current offset within the run that follows the scope's most recent anchor.
+    schema_t::m_layout[node].anchor = scope.anchor;
+    schema_t::m_layout[node].offset = run_size;
+
+    if(definition.is_array())
+    {
+        // Fixed length arrays of fixed size elements are just part of the current run.
+        if(schema_t::is_folded(definition))
+        {
+            schema_t::layout_instance(node);
+            run_size += definition.array_length * definition.serialized_size;
+            return;
+        }
+
+        // Otherwise the array is an anchor, and must start after the current run.
+        schema_t::flush_run(run_size);
+        uint32_t slot = scope.anchors++;
+        schema_t::m_layout[node].slot = slot;
+        uint32_t array_index = static_cast<uint32_t>(schema_t::m_plan.size());
+        instruction_t array_instruction = {opcode_t::ARRAY, slot, 0, 0, 0, 0, 0};
+        if(definition.array_type == definition_t::array_type_t::FIXED_LENGTH)
+        {
+            array_instruction.count = definition.array_length;
+        }
+        schema_t::m_plan.push_back(array_instruction);
+
+        if(definition.fixed_size)
+        {
+            // Elements with a fixed size are jumped over, and their fields are found by offset.
+            schema_t::m_plan[array_index].stride = definition.serialized_size;
+            schema_t::layout_instance(node);
+        }
+        else
+        {
+            // Each element with a variable size is its own scope.
+            scope_t element_scope = {-1, 0};
+            if(definition.is_primitive())
+            {
+                // Only strings are variable sized primitives. The element itself is the string.
+                schema_t::m_plan.push_back({opcode_t::STRING, element_scope.anchors++, 0, 0, 0, 0, 0});
+            }
+            else
+            {
+                uint32_t element_run_size = 0;
+                schema_t::compile_fields(node, element_scope, element_run_size);
+                schema_t::flush_run(element_run_size);
+            }
+            schema_t::m_plan[array_index].anchors = element_scope.anchors;
+            schema_t::m_layout[node].anchors = element_scope.anchors;
+        }
+
+        // Link the array to the end of its body.
+        schema_t::m_plan[array_index].jump = static_cast<uint32_t>(schema_t::m_plan.size());
+        schema_t::m_plan.push_back({opcode_t::END_ARRAY, slot, 0, 0, 0, 0, array_index});
+
+        // The following fields are positioned from the end of the array.
+        scope.anchor = static_cast<int32_t>(slot);
+    }
+    else if(definition.is_primitive())
+    {
+        if(definition.fixed_size)
+        {
+            // The field is part of the current run.
+            run_size += definition.size;
+        }
+        else
+        {
+            // Strings are anchors, and must start after the current run.
+            schema_t::flush_run(run_size);
+            uint32_t slot = scope.anchors++;
+            schema_t::m_layout[node].slot = slot;
+            schema_t::m_plan.push_back({opcode_t::STRING, slot, 0, 0, 0, 0, 0});
+
+            // The following fields are positioned from the end of the string.
+            scope.anchor = static_cast<int32_t>(slot);
+        }
+    }
+    else
+    {
+        // Nested messages are flattened into the current run.
+        schema_t::compile_fields(node, scope, run_size);
+    }
+}
+void schema_t::flush_run(uint32_t& run_size)
+{
+    if(run_size != 0)
+    {
+        schema_t::m_plan.push_back({opcode_t::ADVANCE, 0, run_size, 0, 0, 0, 0});
+        run_size = 0;
+    }
+}
+
+// PATTERNS
+void schema_t::resolve_pattern(const std::string& pattern, pattern_t& resolved) const
+{
+    resolved.valid = false;
+    resolved.parts.clear();
+    resolved.whole_array = false;
+    resolved.primitive_type = definition_t::primitive_type_t::NON_PRIMITIVE;
+
+    // Walk each part of the pattern through the layout.
+    uint32_t node = 0;
+    size_t part_start = 0;
+    while(part_start <= pattern.size())
+    {
+        // Find the end of the part, and if it is an indexed array.
+        size_t part_end = pattern.find('.', part_start);
+        if(part_end == std::string::npos)
+        {
+            part_end = pattern.size();
+        }
+        size_t name_end = part_end;
+        bool indexed = false;
+        if(name_end - part_start >= 2 && pattern.compare(name_end - 2, 2, "[]") == 0)
+        {
+            name_end -= 2;
+            indexed = true;
+        }
+        if(name_end == part_start)
+        {
+            return;
+        }
+
+        // Find the field matching the name.
+        const node_t& parent = schema_t::m_nodes[node];
+        uint32_t field = 0;
+        for(; field < parent.n_fields; ++field)
+        {
+            const std::string& name = *(schema_t::m_nodes[parent.first_field + field].name);
+            if(name.size() == name_end - part_start && pattern.compare(part_start, name.size(), name) == 0)
+            {
+                break;
+            }
+        }
+        if(field == parent.n_fields)
+        {
+            return;
+        }
+        node = parent.first_field + field;
+        resolved.parts.push_back({field, indexed});
+
+        // Array fields must be indexed, except for a whole array at the end of the pattern.
+        bool last = (part_end == pattern.size());
+        if(indexed != schema_t::m_nodes[node].is_array())
+        {
+            if(indexed || !last)
+            {
+                return;
+            }
+            resolved.whole_array = true;
+        }
+
+        part_start = part_end + 1;
+    }
+
+    // Only primitive fields, and whole arrays of fixed size primitives, can be read.
+    const node_t& definition = schema_t::m_nodes[node];
+    if(!definition.is_primitive() || (resolved.whole_array && !definition.fixed_size))
+    {
+        return;
+    }
+
+    resolved.primitive_type = definition.primitive_type;
+    resolved.valid = true;
+}
\ No newline at end of file